@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <stdexcept>
+#include "batch_simulator.h"
+
+// Copy the record at a trace index, decoding up to it if necessary
+bool SharedTraceWindow::fetch(uint64_t index, TraceRecord& record) {
+    if (index >= end()) {
+        extend(index + 1);
+        if (index >= end()) {
+            return false;
+        }
+    }
+    record = m_records[index - m_base];
+    return true;
+}
+
+// Decode records until the window reaches trace index end or the trace runs out
+void SharedTraceWindow::extend(uint64_t end) {
+    TraceRecord record;
+    while (!m_exhausted && this->end() < end) {
+        if (m_source.next(record)) {
+            m_records.push_back(record);
+        }
+        else {
+            m_exhausted = true;
+        }
+    }
+}
+
+// Drop the records before trace index begin
+void SharedTraceWindow::release(uint64_t begin) {
+    while (m_base < begin && !m_records.empty()) {
+        m_records.pop_front();
+        m_base++;
+    }
+}
+
+BatchSimulator::BatchSimulator(InstructionSource& source, const SimulationOptions& options, size_t windowSize) :
+    m_window(source),
+    m_options(options),
+    m_windowSize(windowSize)
+{
+    if (m_windowSize == 0) {
+        throw std::invalid_argument("batch window must hold at least 1 record");
+    }
+}
+
+// Add a configuration with its own engine, source cursor and (optional) retire sink
+size_t BatchSimulator::addConfiguration(const ProcessorParameters& config, RetireSink* retireSink) {
+    size_t index = m_configs.size();
+    m_configs.push_back(config);
+    m_cursors.push_back(0);
+    m_active.push_back(0);
+    m_instructions.push_back(0);
+    m_cycles.push_back(0);
+    m_errors.push_back(std::string());
+    m_sources.emplace_back(new BatchInstructionSource(m_window, m_cursors, index));
+    m_engines.emplace_back();
+
+    SimulationOptions options = m_options;
+    options.retireSink = retireSink;
+    try {
+        m_engines[index] = makeProcessor(config, *m_sources[index], options);
+        m_active[index] = 1;
+    }
+    catch (const std::exception& e) {
+        m_errors[index] = e.what();
+    }
+    return index;
+}
+
+// Stop simulating a configuration and record its outcome
+void BatchSimulator::finish(size_t index, const std::string& error) {
+    m_active[index] = 0;
+    m_errors[index] = error;
+    if (error.empty()) {
+        m_instructions[index] = m_engines[index]->instructionCount();
+        m_cycles[index] = m_engines[index]->cycleCount();
+    }
+    m_engines[index].reset();  // Release the pipeline structures early
+}
+
+// Lockstep rounds: decode the next window, advance each configuration past it, drop what every
+// configuration has fetched. Once the trace is exhausted, the last round drains every pipeline.
+void BatchSimulator::simulate() {
+    size_t active = std::count(m_active.begin(), m_active.end(), 1);
+    uint64_t target = m_window.end();
+
+    while (active > 0) {
+        target += m_windowSize;
+        m_window.extend(target);
+        bool draining = m_window.exhausted();
+
+        for (size_t i = 0; i < m_configs.size(); i++) {
+            if (!m_active[i]) {
+                continue;
+            }
+
+            SimulationEngine& engine = *m_engines[i];
+            try {
+                while (draining || m_cursors[i] < target) {
+                    if (!engine.stepCycle()) {
+                        finish(i, std::string());
+                        active--;
+                        break;
+                    }
+                }
+            }
+            catch (const std::exception& e) {
+                finish(i, e.what());
+                active--;
+            }
+        }
+
+        // Oldest record any running configuration may still fetch
+        uint64_t oldest = target;
+        for (size_t i = 0; i < m_configs.size(); i++) {
+            if (m_active[i]) {
+                oldest = std::min(oldest, m_cursors[i]);
+            }
+        }
+        m_window.release(oldest);
+    }
+}
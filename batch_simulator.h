@@ -0,0 +1,110 @@
+#ifndef BATCH_SIMULATOR_H
+#define BATCH_SIMULATOR_H
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "processor.h"
+
+// Default number of trace records each configuration of a batch simulates per lockstep round
+#define BATCH_DEFAULT_WINDOW 4096
+
+// SharedTraceWindow: Sliding window of decoded trace records shared by the configurations of a
+// batch. Records are read from the underlying source once, on first use, and dropped once every
+// configuration has fetched past them.
+class SharedTraceWindow {
+private:
+    InstructionSource& m_source;         // Underlying trace (owned by the caller)
+    std::deque<TraceRecord> m_records;   // Decoded records, trace index m_base first
+    uint64_t m_base;                     // Trace index of the oldest record kept
+    bool m_exhausted;                    // The underlying source ran out
+
+public:
+    explicit SharedTraceWindow(InstructionSource& source) : m_source(source), m_base(0), m_exhausted(false) {}
+
+    // Copy the record at a trace index (not yet released), decoding up to it if necessary;
+    // returns false past the end of the trace
+    bool fetch(uint64_t index, TraceRecord& record);
+
+    // Decode records until the window reaches trace index end or the trace runs out
+    void extend(uint64_t end);
+
+    // Drop the records before trace index begin
+    void release(uint64_t begin);
+
+    uint64_t end() const { return m_base + m_records.size(); }  // Trace index after the newest record
+    bool exhausted() const { return m_exhausted; }
+};
+
+// BatchInstructionSource: One configuration's view of a shared window; its position lives in the
+// batch's cursor array
+class BatchInstructionSource : public InstructionSource {
+private:
+    SharedTraceWindow& m_window;
+    std::vector<uint64_t>& m_cursors;  // Trace index of the next record, per configuration
+    size_t m_index;                    // This configuration's slot in m_cursors
+
+public:
+    BatchInstructionSource(SharedTraceWindow& window, std::vector<uint64_t>& cursors, size_t index) :
+        m_window(window), m_cursors(cursors), m_index(index)
+    {}
+
+    bool next(TraceRecord& record) override {
+        if (!m_window.fetch(m_cursors[m_index], record)) {
+            return false;
+        }
+        m_cursors[m_index]++;
+        return true;
+    }
+};
+
+// BatchSimulator: Simulates several configurations over one pass of a trace. Each lockstep
+// round decodes the next window of records once, then advances every configuration until it
+// has fetched past the window, so records are read from the source a single time and stay in
+// cache while all configurations use them. Each configuration runs its own engine, so its
+// results are exactly those of a standalone run. Per-configuration progress and results are
+// kept in parallel arrays indexed by configuration.
+class BatchSimulator {
+private:
+    SharedTraceWindow m_window;  // Records shared by all configurations
+    SimulationOptions m_options; // Engine options (the retire sink is set per configuration)
+    size_t m_windowSize;         // Records per lockstep round
+
+    // Per-Configuration State (indexed by configuration)
+    std::vector<ProcessorParameters> m_configs;
+    std::vector<std::unique_ptr<BatchInstructionSource>> m_sources;
+    std::vector<std::unique_ptr<SimulationEngine>> m_engines;  // nullptr if construction failed
+    std::vector<uint64_t> m_cursors;        // Trace index of the next record to fetch
+    std::vector<uint8_t> m_active;          // Still simulating
+    std::vector<uint64_t> m_instructions;   // Instructions fetched, once finished
+    std::vector<uint64_t> m_cycles;         // Cycles simulated, once finished
+    std::vector<std::string> m_errors;      // Why the configuration failed; empty on success
+
+    // Stop simulating a configuration and record its outcome
+    void finish(size_t index, const std::string& error);
+
+public:
+    // The source and every retire sink are borrowed; windowSize must be at least 1
+    BatchSimulator(
+        InstructionSource& source,
+        const SimulationOptions& options = SimulationOptions(),
+        size_t windowSize = BATCH_DEFAULT_WINDOW
+    );
+
+    // Add a configuration before simulate(); returns its index. A configuration the engine
+    // rejects is kept with its error instead of throwing.
+    size_t addConfiguration(const ProcessorParameters& config, RetireSink* retireSink = nullptr);
+
+    // Run every configuration to completion
+    void simulate();
+
+    // Results, by configuration index
+    size_t size() const { return m_configs.size(); }
+    const ProcessorParameters& config(size_t index) const { return m_configs[index]; }
+    uint64_t instructionCount(size_t index) const { return m_instructions[index]; }
+    uint64_t cycleCount(size_t index) const { return m_cycles[index]; }
+    const std::string& error(size_t index) const { return m_errors[index]; }
+};
+
+#endif // BATCH_SIMULATOR_H
@@ -0,0 +1,67 @@
+#ifndef BIT_VECTOR_H
+#define BIT_VECTOR_H
+
+#include <cstdint>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// BitVector: Fixed-size bit set with word-level search for the next set bit
+class BitVector {
+private:
+    std::vector<uint64_t> m_words;  // Bit storage, padded to a multiple of four words
+    size_t m_size;                  // Number of addressable bits
+
+public:
+    explicit BitVector(size_t size = 0) { resize(size); }
+
+    // Resize and clear every bit
+    void resize(size_t size) {
+        m_size = size;
+        m_words.assign(((size + 255) / 256) * 4, 0);
+    }
+
+    size_t size() const { return m_size; }
+
+    void set(size_t bit)   { m_words[bit >> 6] |= uint64_t(1) << (bit & 63); }
+    void clear(size_t bit) { m_words[bit >> 6] &= ~(uint64_t(1) << (bit & 63)); }
+    bool test(size_t bit) const { return (m_words[bit >> 6] >> (bit & 63)) & 1; }
+
+    // Find the first set bit in [from, end); returns -1 if there is none
+    long findNext(size_t from, size_t end) const {
+        if (from >= end) {
+            return -1;
+        }
+
+        size_t word = from >> 6;
+        size_t lastWord = (end - 1) >> 6;
+        uint64_t bits = m_words[word] & (~uint64_t(0) << (from & 63));
+
+        while (bits == 0) {
+            if (++word > lastWord) {
+                return -1;
+            }
+#ifdef __AVX2__
+            // Skip empty stretches 256 bits at a time
+            while ((word & 3) == 0 && word + 3 <= lastWord) {
+                __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_words[word]));
+                if (!_mm256_testz_si256(block, block)) {
+                    break;
+                }
+                word += 4;
+            }
+            if (word > lastWord) {
+                return -1;
+            }
+#endif
+            bits = m_words[word];
+        }
+
+        size_t bit = (word << 6) + __builtin_ctzll(bits);
+        return bit < end ? static_cast<long>(bit) : -1;
+    }
+};
+
+#endif // BIT_VECTOR_H
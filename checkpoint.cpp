@@ -0,0 +1,416 @@
+#include <cstring>
+#include <stdexcept>
+#include "checkpoint.h"
+#include "processor.h"
+
+// Constructor: Create a temporary file next to the checkpoint; close() renames it into place
+CheckpointWriter::CheckpointWriter(const std::string& path) :
+    m_file(nullptr),
+    m_path(path)
+{
+    m_file = fopen((m_path + ".tmp").c_str(), "wb");
+    if (!m_file) {
+        throw std::runtime_error("could not create checkpoint " + m_path);
+    }
+}
+
+// Destructor: Discard an unfinished checkpoint
+CheckpointWriter::~CheckpointWriter() {
+    if (m_file) {
+        fclose(m_file);
+        remove((m_path + ".tmp").c_str());
+    }
+}
+
+void CheckpointWriter::putBytes(const void* data, size_t size) {
+    if (fwrite(data, 1, size, m_file) != size) {
+        throw std::runtime_error("failed writing checkpoint " + m_path);
+    }
+}
+
+// Flush and atomically replace any previous checkpoint, so a preempted run never leaves a torn file
+void CheckpointWriter::close() {
+    FILE* file = m_file;
+    m_file = nullptr;
+    if (fclose(file) != 0 || rename((m_path + ".tmp").c_str(), m_path.c_str()) != 0) {
+        remove((m_path + ".tmp").c_str());
+        throw std::runtime_error("failed writing checkpoint " + m_path);
+    }
+}
+
+// Constructor: Open a checkpoint for reading
+CheckpointReader::CheckpointReader(const std::string& path) :
+    m_file(fopen(path.c_str(), "rb")),
+    m_path(path)
+{
+    if (!m_file) {
+        throw std::runtime_error("could not open checkpoint " + m_path);
+    }
+}
+
+// Destructor: Close the checkpoint
+CheckpointReader::~CheckpointReader() {
+    fclose(m_file);
+}
+
+void CheckpointReader::getBytes(void* data, size_t size) {
+    if (fread(data, 1, size, m_file) != size) {
+        throw std::runtime_error("truncated checkpoint " + m_path);
+    }
+}
+
+int32_t CheckpointReader::getIndex(int32_t low, int32_t high) {
+    int32_t value = getI32();
+    if (value < low || value >= high) {
+        throw std::runtime_error("malformed checkpoint " + m_path);
+    }
+    return value;
+}
+
+void CheckpointReader::expectEnd() {
+    if (fgetc(m_file) != EOF) {
+        throw std::runtime_error("malformed checkpoint " + m_path + " (trailing data)");
+    }
+}
+
+// Write the timing record of an in-flight instruction
+static void putInstruction(CheckpointWriter& out, const Instruction& inst) {
+    out.putU64(inst.pc);
+    out.putU64(inst.sequenceNum);
+    out.putI32(inst.opType);
+    out.putI32(inst.destReg);
+    out.putI32(inst.destRename);
+    out.putI32(inst.src1Reg);
+    out.putI32(inst.src1Rename);
+    out.putI32(inst.src2Reg);
+    out.putI32(inst.src2Rename);
+    out.putU8(inst.valid);
+
+    const int* cycles[] = {
+        &inst.fetchCycle, &inst.decodeCycle, &inst.renameCycle, &inst.regReadCycle,
+        &inst.dispatchCycle, &inst.issueCycle, &inst.executeCycle, &inst.writebackCycle,
+        &inst.retireCycle, &inst.fetchDuration, &inst.decodeDuration, &inst.renameDuration,
+        &inst.regReadDuration, &inst.dispatchDuration, &inst.issueDuration, &inst.executeDuration,
+        &inst.writebackDuration, &inst.retireDuration
+    };
+    for (const int* field : cycles) {
+        out.putI32(*field);
+    }
+}
+
+// Read the timing record of an in-flight instruction
+static void getInstruction(CheckpointReader& in, Instruction& inst) {
+    inst.pc = in.getU64();
+    inst.sequenceNum = in.getU64();
+    inst.opType = in.getI32();
+    inst.destReg = in.getI32();
+    inst.destRename = in.getI32();
+    inst.src1Reg = in.getI32();
+    inst.src1Rename = in.getI32();
+    inst.src2Reg = in.getI32();
+    inst.src2Rename = in.getI32();
+    inst.valid = in.getU8();
+
+    int* cycles[] = {
+        &inst.fetchCycle, &inst.decodeCycle, &inst.renameCycle, &inst.regReadCycle,
+        &inst.dispatchCycle, &inst.issueCycle, &inst.executeCycle, &inst.writebackCycle,
+        &inst.retireCycle, &inst.fetchDuration, &inst.decodeDuration, &inst.renameDuration,
+        &inst.regReadDuration, &inst.dispatchDuration, &inst.issueDuration, &inst.executeDuration,
+        &inst.writebackDuration, &inst.retireDuration
+    };
+    for (int* field : cycles) {
+        *field = in.getI32();
+    }
+}
+
+// Write a pipeline latch as a count followed by its handles
+template <typename Latch>
+static void putHandles(CheckpointWriter& out, const Latch& handles) {
+    out.putU32(handles.size());
+    for (int handle : handles) {
+        out.putI32(handle);
+    }
+}
+
+// Read a pipeline latch written by putHandles
+template <typename Latch>
+static void getHandles(CheckpointReader& in, Latch& handles, int handleCount) {
+    handles.clear();
+    uint32_t count = in.getU32();
+    for (uint32_t i = 0; i < count; i++) {
+        handles.push_back(in.getIndex(0, handleCount));
+    }
+}
+
+// Reject a latch holding a handle outside the given set of in-flight instructions
+template <typename Latch>
+static void checkHandles(const Latch& handles, const std::vector<bool>& held, const std::string& path) {
+    for (int handle : handles) {
+        if (!held[handle]) {
+            throw std::runtime_error("malformed checkpoint " + path);
+        }
+    }
+}
+
+// Save all microarchitectural state and the trace offset. Must be called between cycles.
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::saveCheckpoint(const std::string& path) const {
+    CheckpointWriter out(path);
+
+    // Header and configuration
+    out.putBytes(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE);
+    out.putU32(CHECKPOINT_VERSION);
+    out.putU32(robSize());
+    out.putU32(iqSize());
+    out.putU32(width());
+    out.putU64(m_pool.fingerprint());
+
+    // Progress counters; the instruction count doubles as the trace offset
+    out.putU64(m_cycleCount);
+    out.putU64(m_instructionCount);
+    out.putU64(m_retiredCount);
+    out.putU8(m_simulationComplete);
+
+    // In-flight instructions: everything in the decode and rename latches or holding a ROB entry
+    std::vector<int> live;
+    for (int handle : m_decodeBuffer) {
+        live.push_back(handle);
+    }
+    for (int handle : m_renameBuffer) {
+        live.push_back(handle);
+    }
+    for (const ReorderBufferEntry& entry : m_reorderBuffer) {
+        if (entry.valid) {
+            live.push_back(entry.handle);
+        }
+    }
+
+    out.putU32(live.size());
+    for (int handle : live) {
+        const InstructionState& state = m_arena.state(handle);
+        out.putI32(handle);
+        out.putI32(state.src1Rename);
+        out.putI32(state.src2Rename);
+        putInstruction(out, m_arena.record(handle));
+    }
+
+    // Pipeline latches
+    putHandles(out, m_decodeBuffer);
+    putHandles(out, m_renameBuffer);
+    putHandles(out, m_registerReadBuffer);
+    putHandles(out, m_dispatchBuffer);
+    putHandles(out, m_writebackBuffer);
+
+    // Reorder Buffer
+    out.putI32(m_robHead);
+    out.putI32(m_robTail);
+    for (const ReorderBufferEntry& entry : m_reorderBuffer) {
+        out.putU8(entry.valid);
+        out.putU8(entry.ready);
+        out.putI32(entry.handle);
+        out.putI32(entry.destArchReg);
+    }
+
+    // Rename Table
+    for (const RenameTableEntry& entry : m_renameTable) {
+        out.putU8(entry.valid);
+        out.putI32(entry.robTag);
+    }
+
+    // Issue Queue and the slots still awaiting their issue stamp
+    for (const IssueQueueEntry& entry : m_issueQueue) {
+        out.putU8(entry.valid);
+        out.putI32(entry.handle);
+    }
+    out.putU32(m_newIssueQueueSlots.size());
+    for (int slot : m_newIssueQueueSlots) {
+        out.putI32(slot);
+    }
+
+    // Execution units, in completion order within each wheel slot
+    for (const std::vector<ExecutionEntry>& slot : m_completionWheel) {
+        out.putU32(slot.size());
+        for (const ExecutionEntry& entry : slot) {
+            out.putI32(entry.handle);
+            out.putI32(entry.latency);
+        }
+    }
+    out.putU32(m_completedExecutions.size());
+    for (const ExecutionEntry& entry : m_completedExecutions) {
+        out.putI32(entry.handle);
+        out.putI32(entry.latency);
+    }
+
+    out.close();
+}
+
+// Resume from a checkpoint taken with the same configuration. The instruction source must be
+// positioned at the start of the trace; it is advanced past the instructions already fetched.
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::restoreCheckpoint(const std::string& path) {
+    CheckpointReader in(path);
+
+    // Header and configuration
+    char magic[CHECKPOINT_MAGIC_SIZE];
+    in.getBytes(magic, sizeof(magic));
+    if (memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE) != 0 || in.getU32() != CHECKPOINT_VERSION) {
+        throw std::runtime_error(path + " is not a checkpoint of this simulator version");
+    }
+    if (in.getU32() != robSize() || in.getU32() != iqSize() || in.getU32() != width() ||
+        in.getU64() != m_pool.fingerprint()) {
+        throw std::runtime_error("checkpoint " + path + " was taken with a different configuration");
+    }
+
+    initializeStructures();
+    int handleCount = m_arena.capacity();
+    int robEntries = robSize();
+    int iqEntries = iqSize();
+
+    // Progress counters
+    m_cycleCount = in.getU64();
+    m_instructionCount = in.getU64();
+    m_retiredCount = in.getU64();
+    m_simulationComplete = in.getU8();
+
+    // In-flight instructions; the hot state is refilled from the timing record
+    std::vector<bool> live(handleCount, false);
+    uint32_t liveCount = in.getU32();
+    for (uint32_t i = 0; i < liveCount; i++) {
+        int handle = in.getIndex(0, handleCount);
+        live[handle] = true;
+
+        InstructionState& state = m_arena.state(handle);
+        state = InstructionState();
+        state.src1Rename = in.getIndex(-1, robEntries);
+        state.src2Rename = in.getIndex(-1, robEntries);
+
+        Instruction& record = m_arena.record(handle);
+        getInstruction(in, record);
+        state.destRename = record.destRename;
+        state.fetchCycle = record.fetchCycle;
+        state.destReg = record.destReg;
+        state.src1Reg = record.src1Reg;
+        state.src2Reg = record.src2Reg;
+        state.opType = record.opType;
+        state.unitClass = m_pool.opClass[functionUnitIndex(record.opType)];
+        state.latency = m_pool.opLatency[functionUnitIndex(record.opType)];
+    }
+    m_arena.rebuildFreeList(live);
+
+    // Pipeline latches
+    getHandles(in, m_decodeBuffer, handleCount);
+    getHandles(in, m_renameBuffer, handleCount);
+    getHandles(in, m_registerReadBuffer, handleCount);
+    getHandles(in, m_dispatchBuffer, handleCount);
+    getHandles(in, m_writebackBuffer, handleCount);
+
+    // Reorder Buffer; every renamed instruction holds a valid entry
+    std::vector<bool> inReorderBuffer(handleCount, false);
+    m_robHead = in.getIndex(0, robEntries);
+    m_robTail = in.getIndex(0, robEntries);
+    for (ReorderBufferEntry& entry : m_reorderBuffer) {
+        entry.valid = in.getU8();
+        entry.ready = in.getU8();
+        entry.handle = in.getIndex(-1, handleCount);
+        entry.destArchReg = in.getI32();
+        if (entry.valid) {
+            if (entry.handle == -1 || !live[entry.handle]) {
+                throw std::runtime_error("malformed checkpoint " + path);
+            }
+            inReorderBuffer[entry.handle] = true;
+            m_robOccupancy++;
+        }
+    }
+
+    // A latch handle outside the live set would alias a free arena slot
+    checkHandles(m_decodeBuffer, live, path);
+    checkHandles(m_renameBuffer, live, path);
+    checkHandles(m_registerReadBuffer, inReorderBuffer, path);
+    checkHandles(m_dispatchBuffer, inReorderBuffer, path);
+    checkHandles(m_writebackBuffer, inReorderBuffer, path);
+
+    // Rename Table
+    for (RenameTableEntry& entry : m_renameTable) {
+        entry.valid = in.getU8();
+        entry.robTag = in.getIndex(-1, robEntries);
+    }
+
+    // Issue Queue; free slots follow from the valid bits
+    m_iqFreeSlots = decltype(m_iqFreeSlots)();
+    for (int slot = 0; slot < iqEntries; slot++) {
+        IssueQueueEntry& entry = m_issueQueue[slot];
+        entry.valid = in.getU8();
+        entry.handle = in.getIndex(-1, handleCount);
+        if (entry.valid) {
+            if (entry.handle == -1 || !inReorderBuffer[entry.handle]) {
+                throw std::runtime_error("malformed checkpoint " + path);
+            }
+            m_arena.state(entry.handle).iqSlot = slot;
+            m_iqOccupancy++;
+        }
+        else {
+            m_iqFreeSlots.push(slot);
+        }
+    }
+    uint32_t newSlots = in.getU32();
+    for (uint32_t i = 0; i < newSlots; i++) {
+        m_newIssueQueueSlots.push_back(in.getIndex(0, iqEntries));
+    }
+
+    // Execution units
+    for (std::vector<ExecutionEntry>& slot : m_completionWheel) {
+        uint32_t count = in.getU32();
+        for (uint32_t i = 0; i < count; i++) {
+            int handle = in.getIndex(0, handleCount);
+            int latency = in.getI32();
+            if (!inReorderBuffer[handle]) {
+                throw std::runtime_error("malformed checkpoint " + path);
+            }
+            slot.push_back(ExecutionEntry(handle, latency));
+            m_executingCount++;
+            m_unitsBusy[m_arena.state(handle).unitClass] += m_unitReleased[m_arena.state(handle).unitClass];
+        }
+    }
+    uint32_t completed = in.getU32();
+    for (uint32_t i = 0; i < completed; i++) {
+        int handle = in.getIndex(0, handleCount);
+        int latency = in.getI32();
+        if (!inReorderBuffer[handle]) {
+            throw std::runtime_error("malformed checkpoint " + path);
+        }
+        m_completedExecutions.push_back(ExecutionEntry(handle, latency));
+        m_executingCount++;
+        m_unitsBusy[m_arena.state(handle).unitClass] += m_unitReleased[m_arena.state(handle).unitClass];
+    }
+    in.expectEnd();
+
+    // Wakeup lists and ready bits follow from the outstanding source tags: every instruction
+    // still holding a tag is woken when it completes, and waiting IQ entries without one are ready
+    for (size_t handle = 0; handle < live.size(); handle++) {
+        if (!live[handle]) {
+            continue;
+        }
+        const InstructionState& state = m_arena.state(handle);
+        if (state.src1Rename != -1) {
+            m_wakeupLists[state.src1Rename].push_back(handle * 2);
+        }
+        if (state.src2Rename != -1) {
+            m_wakeupLists[state.src2Rename].push_back(handle * 2 + 1);
+        }
+        if (state.iqSlot != -1 && isInstructionReady(state.iqSlot)) {
+            m_readyBits.set(state.destRename);
+        }
+    }
+
+    // Skip the instructions fetched before the checkpoint
+    if (m_source.skip(m_instructionCount) != m_instructionCount) {
+        throw std::runtime_error("trace is shorter than checkpoint " + path);
+    }
+}
+
+// Instantiate the checkpoint methods of every engine built in processor.cpp
+#define INSTANTIATE_CHECKPOINTS(WIDTH, ROB_SIZE, IQ_SIZE) \
+    template void OutOfOrderProcessor<WIDTH, ROB_SIZE, IQ_SIZE>::saveCheckpoint(const std::string&) const; \
+    template void OutOfOrderProcessor<WIDTH, ROB_SIZE, IQ_SIZE>::restoreCheckpoint(const std::string&);
+INSTANTIATE_CHECKPOINTS(0, 0, 0)
+SPECIALIZED_CONFIGURATIONS(INSTANTIATE_CHECKPOINTS)
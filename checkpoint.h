@@ -0,0 +1,59 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Checkpoint File Format
+// An 8-byte magic and a version, followed by fixed-width fields (host byte order) written in the
+// order of OutOfOrderProcessor::saveCheckpoint(). Only primary state is stored; structures that
+// follow from it (free lists, wakeup lists, ready bits) are rebuilt on restore.
+#define CHECKPOINT_MAGIC "OOOCHKPT"
+#define CHECKPOINT_MAGIC_SIZE 8
+#define CHECKPOINT_VERSION 2
+
+// CheckpointWriter: Sequential binary writer for checkpoint files
+class CheckpointWriter {
+private:
+    FILE* m_file;       // Output file (owned)
+    std::string m_path; // Path, for error messages
+
+public:
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter();
+
+    void putBytes(const void* data, size_t size);
+    void putU8(uint8_t value) { putBytes(&value, sizeof(value)); }
+    void putI32(int32_t value) { putBytes(&value, sizeof(value)); }
+    void putU32(uint32_t value) { putBytes(&value, sizeof(value)); }
+    void putU64(uint64_t value) { putBytes(&value, sizeof(value)); }
+
+    // Flush and close; throws if any write failed
+    void close();
+};
+
+// CheckpointReader: Sequential binary reader for checkpoint files; throws on truncated input
+class CheckpointReader {
+private:
+    FILE* m_file;       // Input file (owned)
+    std::string m_path; // Path, for error messages
+
+public:
+    explicit CheckpointReader(const std::string& path);
+    ~CheckpointReader();
+
+    void getBytes(void* data, size_t size);
+    uint8_t getU8() { uint8_t value; getBytes(&value, sizeof(value)); return value; }
+    int32_t getI32() { int32_t value; getBytes(&value, sizeof(value)); return value; }
+    uint32_t getU32() { uint32_t value; getBytes(&value, sizeof(value)); return value; }
+    uint64_t getU64() { uint64_t value; getBytes(&value, sizeof(value)); return value; }
+
+    // Read an index and check it lies in [low, high)
+    int32_t getIndex(int32_t low, int32_t high);
+
+    // Check that the whole file was consumed
+    void expectEnd();
+};
+
+#endif // CHECKPOINT_H
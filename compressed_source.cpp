@@ -0,0 +1,391 @@
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "compressed_source.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+// Size of the compressed input chunk read from disk per decoder call
+#define COMPRESSED_CHUNK_SIZE (256 * 1024)
+
+// Size of the decoded block buffer feeding the fetch stage
+#define DECODED_BLOCK_SIZE (1024 * 1024)
+
+// Identify the compression format from the first bytes of a file
+TraceCodec detectTraceCodec(const unsigned char* magic, size_t length) {
+    if (length >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        return TraceCodec::Gzip;
+    }
+    if (length >= 6 && memcmp(magic, "\xfd" "7zXZ\0", 6) == 0) {
+        return TraceCodec::Xz;
+    }
+    if (length >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return TraceCodec::Zstd;
+    }
+    return TraceCodec::None;
+}
+
+// Human-readable codec name for diagnostics
+const char* traceCodecName(TraceCodec codec) {
+    switch (codec) {
+        case TraceCodec::Gzip: return "gzip";
+        case TraceCodec::Xz:   return "xz";
+        case TraceCodec::Zstd: return "zstd";
+        default:               return "none";
+    }
+}
+
+// Check whether support for a codec was compiled into this build
+bool isTraceCodecAvailable(TraceCodec codec) {
+    switch (codec) {
+#ifdef HAVE_ZLIB
+        case TraceCodec::Gzip: return true;
+#endif
+#ifdef HAVE_LZMA
+        case TraceCodec::Xz:   return true;
+#endif
+#ifdef HAVE_ZSTD
+        case TraceCodec::Zstd: return true;
+#endif
+        case TraceCodec::None: return true;
+        default:               return false;
+    }
+}
+
+#ifdef HAVE_ZLIB
+// GzipTraceDecoder: Inflates (possibly multi-member) gzip streams with zlib
+class GzipTraceDecoder : public TraceDecoder {
+private:
+    FILE* m_file;
+    z_stream m_stream;
+    std::vector<unsigned char> m_input;
+    bool m_memberEnded;   // Last inflate call finished a gzip member
+    bool m_finished;
+
+public:
+    explicit GzipTraceDecoder(FILE* file) :
+        m_file(file), m_input(COMPRESSED_CHUNK_SIZE), m_memberEnded(false), m_finished(false)
+    {
+        memset(&m_stream, 0, sizeof(m_stream));
+        // 15 + 32: maximum window, automatic gzip/zlib header detection
+        if (inflateInit2(&m_stream, 15 + 32) != Z_OK) {
+            fclose(m_file);
+            throw std::runtime_error("could not initialise gzip decoder");
+        }
+    }
+
+    ~GzipTraceDecoder() {
+        inflateEnd(&m_stream);
+        fclose(m_file);
+    }
+
+    size_t read(char* out, size_t capacity) override {
+        m_stream.next_out = reinterpret_cast<Bytef*>(out);
+        m_stream.avail_out = capacity;
+
+        while (m_stream.avail_out > 0 && !m_finished) {
+            if (m_stream.avail_in == 0) {
+                size_t count = fread(m_input.data(), 1, m_input.size(), m_file);
+                if (count == 0) {
+                    if (!m_memberEnded) {
+                        throw std::runtime_error("gzip trace is truncated");
+                    }
+                    m_finished = true;
+                    break;
+                }
+                m_stream.next_in = m_input.data();
+                m_stream.avail_in = count;
+            }
+
+            int ret = inflate(&m_stream, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                // Another member may follow (e.g. concatenated or pigz output)
+                m_memberEnded = true;
+                inflateReset(&m_stream);
+            }
+            else if (ret == Z_OK || ret == Z_BUF_ERROR) {
+                m_memberEnded = false;
+            }
+            else {
+                throw std::runtime_error("corrupt gzip trace");
+            }
+        }
+
+        return capacity - m_stream.avail_out;
+    }
+};
+#endif
+
+#ifdef HAVE_LZMA
+// XzTraceDecoder: Decodes (possibly concatenated) xz streams with liblzma
+class XzTraceDecoder : public TraceDecoder {
+private:
+    FILE* m_file;
+    lzma_stream m_stream;
+    std::vector<uint8_t> m_input;
+    bool m_inputEnded;
+    bool m_finished;
+
+public:
+    explicit XzTraceDecoder(FILE* file) :
+        m_file(file), m_stream(LZMA_STREAM_INIT), m_input(COMPRESSED_CHUNK_SIZE),
+        m_inputEnded(false), m_finished(false)
+    {
+        if (lzma_stream_decoder(&m_stream, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) {
+            fclose(m_file);
+            throw std::runtime_error("could not initialise xz decoder");
+        }
+    }
+
+    ~XzTraceDecoder() {
+        lzma_end(&m_stream);
+        fclose(m_file);
+    }
+
+    size_t read(char* out, size_t capacity) override {
+        m_stream.next_out = reinterpret_cast<uint8_t*>(out);
+        m_stream.avail_out = capacity;
+
+        while (m_stream.avail_out > 0 && !m_finished) {
+            if (m_stream.avail_in == 0 && !m_inputEnded) {
+                size_t count = fread(m_input.data(), 1, m_input.size(), m_file);
+                m_inputEnded = (count == 0);
+                m_stream.next_in = m_input.data();
+                m_stream.avail_in = count;
+            }
+
+            lzma_ret ret = lzma_code(&m_stream, m_inputEnded ? LZMA_FINISH : LZMA_RUN);
+            if (ret == LZMA_STREAM_END) {
+                m_finished = true;
+            }
+            else if (ret != LZMA_OK) {
+                throw std::runtime_error("corrupt or truncated xz trace");
+            }
+        }
+
+        return capacity - m_stream.avail_out;
+    }
+};
+#endif
+
+#ifdef HAVE_ZSTD
+// ZstdTraceDecoder: Decodes (possibly multi-frame) zstd streams with libzstd
+class ZstdTraceDecoder : public TraceDecoder {
+private:
+    FILE* m_file;
+    ZSTD_DStream* m_stream;
+    std::vector<char> m_input;
+    ZSTD_inBuffer m_inBuffer;
+    bool m_frameEnded;    // Last call completed a frame
+    bool m_finished;
+
+public:
+    explicit ZstdTraceDecoder(FILE* file) :
+        m_file(file), m_stream(ZSTD_createDStream()), m_input(COMPRESSED_CHUNK_SIZE),
+        m_frameEnded(false), m_finished(false)
+    {
+        if (!m_stream || ZSTD_isError(ZSTD_initDStream(m_stream))) {
+            ZSTD_freeDStream(m_stream);
+            fclose(m_file);
+            throw std::runtime_error("could not initialise zstd decoder");
+        }
+        m_inBuffer.src = m_input.data();
+        m_inBuffer.size = 0;
+        m_inBuffer.pos = 0;
+    }
+
+    ~ZstdTraceDecoder() {
+        ZSTD_freeDStream(m_stream);
+        fclose(m_file);
+    }
+
+    size_t read(char* out, size_t capacity) override {
+        ZSTD_outBuffer outBuffer = { out, capacity, 0 };
+
+        while (outBuffer.pos < outBuffer.size && !m_finished) {
+            if (m_inBuffer.pos == m_inBuffer.size) {
+                size_t count = fread(m_input.data(), 1, m_input.size(), m_file);
+                if (count == 0) {
+                    if (!m_frameEnded) {
+                        throw std::runtime_error("zstd trace is truncated");
+                    }
+                    m_finished = true;
+                    break;
+                }
+                m_inBuffer.size = count;
+                m_inBuffer.pos = 0;
+            }
+
+            size_t ret = ZSTD_decompressStream(m_stream, &outBuffer, &m_inBuffer);
+            if (ZSTD_isError(ret)) {
+                throw std::runtime_error(std::string("corrupt zstd trace: ") + ZSTD_getErrorName(ret));
+            }
+            m_frameEnded = (ret == 0);
+        }
+
+        return outBuffer.pos;
+    }
+};
+#endif
+
+// Create the decoder matching a codec
+static std::unique_ptr<TraceDecoder> createTraceDecoder(const std::string& path, TraceCodec codec) {
+    if (!isTraceCodecAvailable(codec) || codec == TraceCodec::None) {
+        throw std::runtime_error("trace " + path + " is " + traceCodecName(codec) +
+                                 "-compressed but this build has no " + traceCodecName(codec) + " support");
+    }
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("could not open trace file " + path);
+    }
+
+    switch (codec) {
+#ifdef HAVE_ZLIB
+        case TraceCodec::Gzip: return std::unique_ptr<TraceDecoder>(new GzipTraceDecoder(file));
+#endif
+#ifdef HAVE_LZMA
+        case TraceCodec::Xz:   return std::unique_ptr<TraceDecoder>(new XzTraceDecoder(file));
+#endif
+#ifdef HAVE_ZSTD
+        case TraceCodec::Zstd: return std::unique_ptr<TraceDecoder>(new ZstdTraceDecoder(file));
+#endif
+        default:
+            fclose(file);
+            throw std::runtime_error("unsupported trace codec");
+    }
+}
+
+// Constructor: Start decoding and determine whether the payload is text or binary
+CompressedInstructionSource::CompressedInstructionSource(const std::string& path, TraceCodec codec) :
+    m_decoder(createTraceDecoder(path, codec)),
+    m_block(DECODED_BLOCK_SIZE + 1),
+    m_begin(0),
+    m_end(0),
+    m_endOfStream(false),
+    m_binary(false),
+    m_recordsLeft(0)
+{
+    m_block[0] = '\0';
+
+    // A compressed binary trace carries the usual header at the start of the payload
+    ensureAvailable(sizeof(BinaryTraceHeader));
+    if (m_end - m_begin >= sizeof(BinaryTraceHeader) &&
+        memcmp(&m_block[m_begin], BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_SIZE) == 0) {
+        BinaryTraceHeader header;
+        memcpy(&header, &m_block[m_begin], sizeof(header));
+        if (header.version != BINARY_TRACE_VERSION || header.recordSize != sizeof(BinaryTraceRecord)) {
+            throw std::runtime_error("malformed binary trace " + path);
+        }
+        m_binary = true;
+        m_recordsLeft = header.recordCount;
+        m_begin += sizeof(header);
+    }
+}
+
+// Move unconsumed bytes to the front and decode more; returns false if nothing was added
+bool CompressedInstructionSource::refill() {
+    if (m_endOfStream) {
+        return false;
+    }
+
+    size_t remaining = m_end - m_begin;
+    memmove(m_block.data(), m_block.data() + m_begin, remaining);
+    m_begin = 0;
+    m_end = remaining;
+
+    size_t count = m_decoder->read(m_block.data() + m_end, DECODED_BLOCK_SIZE - m_end);
+    m_end += count;
+    m_block[m_end] = '\0';
+    if (count == 0) {
+        m_endOfStream = true;
+    }
+    return count > 0;
+}
+
+// Ensure at least count unconsumed bytes are available (or the stream ended)
+bool CompressedInstructionSource::ensureAvailable(size_t count) {
+    while (m_end - m_begin < count) {
+        if (!refill()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Skip whitespace and decode until the following token is whole in the buffer, however much
+// padding precedes it; returns the token (NUL terminated at the end of the decoded bytes)
+char* CompressedInstructionSource::nextToken() {
+    while (true) {
+        while (m_begin < m_end && isspace(static_cast<unsigned char>(m_block[m_begin]))) {
+            m_begin++;
+        }
+        if (m_begin < m_end || !refill()) {
+            break;
+        }
+    }
+
+    size_t length = 0;
+    while (true) {
+        while (m_begin + length < m_end && !isspace(static_cast<unsigned char>(m_block[m_begin + length]))) {
+            length++;
+        }
+        // A token filling the whole block cannot grow further; parse what fits
+        if (m_begin + length < m_end || length == DECODED_BLOCK_SIZE || !refill()) {
+            break;
+        }
+    }
+    return &m_block[m_begin];
+}
+
+// Parse one "<PC> <op> <dest> <src1> <src2>" record with the same rules as fscanf("%lx %d %d %d %d")
+bool CompressedInstructionSource::nextText(TraceRecord& record) {
+    char* cursor = nextToken();
+    char* end;
+
+    record.pc = strtoull(cursor, &end, 16);
+    if (end == cursor) return false;
+    m_begin = end - m_block.data();
+
+    int* fields[4] = { &record.opType, &record.destReg, &record.src1Reg, &record.src2Reg };
+    for (int* field : fields) {
+        cursor = nextToken();
+        *field = static_cast<int>(strtol(cursor, &end, 10));
+        if (end == cursor) return false;
+        m_begin = end - m_block.data();
+    }
+    return true;
+}
+
+// Copy one packed record out of the block buffer
+bool CompressedInstructionSource::nextBinary(TraceRecord& record) {
+    if (m_recordsLeft == 0 || !ensureAvailable(sizeof(BinaryTraceRecord))) {
+        return false;
+    }
+
+    BinaryTraceRecord packed;
+    memcpy(&packed, &m_block[m_begin], sizeof(packed));
+    m_begin += sizeof(packed);
+    m_recordsLeft--;
+
+    record.pc = packed.pc;
+    record.opType = packed.opType;
+    record.destReg = packed.destReg;
+    record.src1Reg = packed.src1Reg;
+    record.src2Reg = packed.src2Reg;
+    return true;
+}
+
+// Return the next decoded trace record
+bool CompressedInstructionSource::next(TraceRecord& record) {
+    return m_binary ? nextBinary(record) : nextText(record);
+}
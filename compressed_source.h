@@ -0,0 +1,64 @@
+#ifndef COMPRESSED_SOURCE_H
+#define COMPRESSED_SOURCE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "instruction_source.h"
+
+// Compression formats recognised by their leading magic bytes
+enum class TraceCodec {
+    None,   // Uncompressed text or binary trace
+    Gzip,   // 1f 8b
+    Xz,     // fd 37 7a 58 5a 00
+    Zstd    // 28 b5 2f fd
+};
+
+// Identify the compression format from the first bytes of a file
+TraceCodec detectTraceCodec(const unsigned char* magic, size_t length);
+
+// Human-readable codec name for diagnostics
+const char* traceCodecName(TraceCodec codec);
+
+// Check whether support for a codec was compiled into this build
+bool isTraceCodecAvailable(TraceCodec codec);
+
+// TraceDecoder: Streams decompressed bytes out of a compressed trace file
+class TraceDecoder {
+public:
+    virtual ~TraceDecoder() {}
+
+    // Fill up to capacity bytes; returns 0 once the stream is exhausted
+    virtual size_t read(char* out, size_t capacity) = 0;
+};
+
+// CompressedInstructionSource: Decodes a compressed text or binary trace through a bounded block buffer
+class CompressedInstructionSource : public InstructionSource {
+private:
+    std::unique_ptr<TraceDecoder> m_decoder;  // Codec-specific stream decoder
+    std::vector<char> m_block;                // Decoded bytes not yet consumed (NUL terminated)
+    size_t m_begin;                           // Offset of the first unconsumed byte
+    size_t m_end;                             // Offset one past the last decoded byte
+    bool m_endOfStream;                       // Decoder has no more data
+    bool m_binary;                            // Decoded payload uses the binary trace format
+    uint64_t m_recordsLeft;                   // Remaining records in a binary payload
+
+    // Move unconsumed bytes to the front and decode more; returns false if nothing was added
+    bool refill();
+
+    // Ensure at least count unconsumed bytes are available (or the stream ended)
+    bool ensureAvailable(size_t count);
+
+    // Skip whitespace (across refills) and return the next token, wholly decoded
+    char* nextToken();
+
+    bool nextText(TraceRecord& record);
+    bool nextBinary(TraceRecord& record);
+
+public:
+    CompressedInstructionSource(const std::string& path, TraceCodec codec);
+
+    bool next(TraceRecord& record) override;
+};
+
+#endif // COMPRESSED_SOURCE_H
@@ -0,0 +1,78 @@
+#ifndef FIXED_STORAGE_H
+#define FIXED_STORAGE_H
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <type_traits>
+#include <vector>
+
+// Structure Storage
+// Entries of a pipeline structure: a std::array when the capacity is a compile-time constant,
+// a std::vector sized at construction when it is 0 (known only at run time).
+template <typename T, size_t Capacity>
+using StructureStorage = typename std::conditional<Capacity == 0, std::vector<T>, std::array<T, Capacity>>::type;
+
+// Reset every entry, sizing run-time storage to count entries
+template <typename T>
+inline void resetStorage(std::vector<T>& storage, size_t count) {
+    storage.assign(count, T());
+}
+
+template <typename T, size_t Capacity>
+inline void resetStorage(std::array<T, Capacity>& storage, size_t) {
+    storage.fill(T());
+}
+
+// Smallest power of two at least value (value >= 1)
+constexpr size_t roundUpPowerOfTwo(size_t value) {
+    return value <= 1 ? 1 : 2 * roundUpPowerOfTwo((value + 1) / 2);
+}
+
+// FixedHandleQueue: FIFO of arena handles holding at most Capacity entries, in an inline ring
+// whose wrap is a mask. Provides the subset of std::deque used by the pipeline latches.
+template <size_t Capacity>
+class FixedHandleQueue {
+private:
+    static const size_t RING_SIZE = roundUpPowerOfTwo(Capacity);
+
+    std::array<int, RING_SIZE> m_ring;
+    size_t m_head;   // Index of the front entry (not wrapped)
+    size_t m_count;  // Number of entries
+
+public:
+    // Forward iterator from front to back
+    class const_iterator {
+    private:
+        const FixedHandleQueue* m_queue;
+        size_t m_offset;  // Position from the front
+
+    public:
+        const_iterator(const FixedHandleQueue* queue, size_t offset) : m_queue(queue), m_offset(offset) {}
+
+        int operator*() const { return m_queue->m_ring[(m_queue->m_head + m_offset) & (RING_SIZE - 1)]; }
+        const_iterator& operator++() { m_offset++; return *this; }
+        bool operator!=(const const_iterator& other) const { return m_offset != other.m_offset; }
+        bool operator==(const const_iterator& other) const { return m_offset == other.m_offset; }
+    };
+
+    FixedHandleQueue() : m_head(0), m_count(0) {}
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    void clear() { m_head = 0; m_count = 0; }
+
+    int front() const { return m_ring[m_head & (RING_SIZE - 1)]; }
+    void push_back(int handle) { m_ring[(m_head + m_count++) & (RING_SIZE - 1)] = handle; }
+    void pop_front() { m_head++; m_count--; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_count); }
+};
+
+// Latch Storage
+// Handles in a pipeline latch: a fixed ring when its bound is a compile-time constant, else a deque
+template <size_t Capacity>
+using LatchStorage = typename std::conditional<Capacity == 0, std::deque<int>, FixedHandleQueue<Capacity>>::type;
+
+#endif // FIXED_STORAGE_H
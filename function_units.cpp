@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "function_units.h"
+
+// The original machine
+FunctionUnitPool::FunctionUnitPool() {
+    classes.push_back({"universal", 5, true, false});
+    for (size_t type = 0; type <= FU_OP_TYPES; type++) {
+        opClass[type] = 0;
+        opLatency[type] = 5;
+    }
+    opLatency[0] = 1;
+    opLatency[1] = 2;
+}
+
+// Longest latency of any op type
+int FunctionUnitPool::maxLatency() const {
+    return *std::max_element(opLatency, opLatency + FU_OP_TYPES + 1);
+}
+
+// Unpipelined units hold one operation each; pipelined ones up to their longest latency
+uint32_t FunctionUnitPool::capacity(uint32_t width) const {
+    uint32_t total = 0;
+    for (size_t unitClass = 0; unitClass < classes.size(); unitClass++) {
+        int depth = 1;
+        if (classes[unitClass].pipelined) {
+            for (size_t type = 0; type <= FU_OP_TYPES; type++) {
+                if (opClass[type] == static_cast<int>(unitClass)) {
+                    depth = std::max(depth, opLatency[type]);
+                }
+            }
+        }
+        total += units(unitClass, width) * depth;
+    }
+    return total;
+}
+
+// FNV-1a over the unit counts, kinds and op-type tables (class names do not affect timing)
+uint64_t FunctionUnitPool::fingerprint() const {
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](uint64_t value) {
+        for (int byte = 0; byte < 8; byte++) {
+            hash = (hash ^ ((value >> (8 * byte)) & 0xff)) * 1099511628211ULL;
+        }
+    };
+
+    mix(classes.size());
+    for (const FunctionUnitClass& unitClass : classes) {
+        mix(unitClass.units);
+        mix(unitClass.perWidth);
+        mix(unitClass.pipelined);
+    }
+    for (size_t type = 0; type <= FU_OP_TYPES; type++) {
+        mix(static_cast<uint64_t>(opClass[type]));
+        mix(static_cast<uint64_t>(opLatency[type]));
+    }
+    return hash;
+}
+
+// Parse the class and op lines of a pool file
+FunctionUnitPool loadFunctionUnitPool(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("could not open function unit file " + path);
+    }
+
+    FunctionUnitPool pool;
+    pool.classes.clear();
+    bool assigned[FU_OP_TYPES + 1] = {false};
+    int otherClass = -1;  // From an "op *" line
+    int otherLatency = 0;
+
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(file, line); lineNumber++) {
+        std::string where = " on line " + std::to_string(lineNumber) + " of " + path;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string keyword;
+        if (!(fields >> keyword)) {
+            continue;  // Blank or comment-only line
+        }
+
+        std::string extra;
+        if (keyword == "class") {
+            std::string name, units, kind;
+            if (!(fields >> name >> units >> kind) || (fields >> extra)) {
+                throw std::runtime_error("malformed class" + where);
+            }
+            for (const FunctionUnitClass& unitClass : pool.classes) {
+                if (unitClass.name == name) {
+                    throw std::runtime_error("duplicate class " + name + where);
+                }
+            }
+            if (pool.classes.size() == FU_MAX_CLASSES) {
+                throw std::runtime_error("more than " + std::to_string(FU_MAX_CLASSES) + " classes" + where);
+            }
+
+            FunctionUnitClass unitClass;
+            unitClass.name = name;
+            unitClass.perWidth = !units.empty() && units.back() == 'w';
+            if (unitClass.perWidth) {
+                units.pop_back();
+            }
+            size_t used = 0;
+            try {
+                unitClass.units = std::stoul(units, &used);
+            }
+            catch (const std::exception&) {
+                used = 0;
+            }
+            if (used == 0 || used != units.size() || unitClass.units == 0) {
+                throw std::runtime_error("unit count must be a positive number, optionally followed by w" + where);
+            }
+            if (kind != "pipelined" && kind != "unpipelined") {
+                throw std::runtime_error("class kind must be pipelined or unpipelined" + where);
+            }
+            unitClass.pipelined = kind == "pipelined";
+            pool.classes.push_back(unitClass);
+        }
+        else if (keyword == "op") {
+            std::string type, name;
+            int latency;
+            if (!(fields >> type >> name >> latency) || (fields >> extra)) {
+                throw std::runtime_error("malformed op" + where);
+            }
+            if (latency < 1 || latency > FU_MAX_LATENCY) {
+                throw std::runtime_error("latency must be 1 to " + std::to_string(FU_MAX_LATENCY) + where);
+            }
+
+            int unitClass = -1;
+            for (size_t i = 0; i < pool.classes.size(); i++) {
+                if (pool.classes[i].name == name) {
+                    unitClass = i;
+                }
+            }
+            if (unitClass == -1) {
+                throw std::runtime_error("op uses undeclared class " + name + where);
+            }
+
+            if (type == "*") {
+                otherClass = unitClass;
+                otherLatency = latency;
+                continue;
+            }
+            size_t used = 0;
+            int opType = -1;
+            try {
+                opType = std::stoi(type, &used);
+            }
+            catch (const std::exception&) {
+                used = 0;
+            }
+            if (used == 0 || used != type.size() || opType < 0 || opType >= FU_OP_TYPES) {
+                throw std::runtime_error("op type must be * or 0 to " + std::to_string(FU_OP_TYPES - 1) + where);
+            }
+            pool.opClass[opType] = unitClass;
+            pool.opLatency[opType] = latency;
+            assigned[opType] = true;
+        }
+        else {
+            throw std::runtime_error("unknown keyword " + keyword + where);
+        }
+    }
+
+    if (pool.classes.empty()) {
+        throw std::runtime_error("function unit file " + path + " declares no class");
+    }
+
+    // Op types without their own line take the "op *" entry, or have no unit at all
+    for (size_t type = 0; type <= FU_OP_TYPES; type++) {
+        if (!assigned[type]) {
+            pool.opClass[type] = otherClass;
+            pool.opLatency[type] = otherClass == -1 ? 1 : otherLatency;
+        }
+    }
+    return pool;
+}
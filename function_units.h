@@ -0,0 +1,61 @@
+#ifndef FUNCTION_UNITS_H
+#define FUNCTION_UNITS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Operation types with their own table entry; every other op type shares one extra entry
+#define FU_OP_TYPES 16
+
+// Most function-unit classes in a pool, and the longest latency a class may have
+#define FU_MAX_CLASSES 8
+#define FU_MAX_LATENCY 64
+
+// Function-Unit Class: a group of identical units
+struct FunctionUnitClass {
+    std::string name;
+    uint32_t units;   // Number of units (per WIDTH when perWidth is set)
+    bool perWidth;    // units scales with the pipeline width
+    bool pipelined;   // A unit accepts a new operation every cycle; otherwise it is busy until its
+                      // operation leaves execute
+};
+
+// FunctionUnitPool: The execution resources of the machine. Each op type maps to a class and a
+// latency; op types at or beyond FU_OP_TYPES all use the entry at index FU_OP_TYPES.
+struct FunctionUnitPool {
+    std::vector<FunctionUnitClass> classes;
+    int opClass[FU_OP_TYPES + 1];    // Class of each op type (-1: no unit can execute it)
+    int opLatency[FU_OP_TYPES + 1];  // Execution latency of each op type, in cycles
+
+    // The original machine: 5 * WIDTH unpipelined universal units, latency 1 for op type 0,
+    // 2 for op type 1 and 5 for everything else
+    FunctionUnitPool();
+
+    // Units of a class in a machine of the given width
+    uint32_t units(size_t unitClass, uint32_t width) const {
+        return classes[unitClass].perWidth ? classes[unitClass].units * width : classes[unitClass].units;
+    }
+
+    // Longest latency of any op type
+    int maxLatency() const;
+
+    // Operations that can be in execution at once in a machine of the given width
+    uint32_t capacity(uint32_t width) const;
+
+    // Hash of everything that affects timing, for checkpoints and result cache keys
+    uint64_t fingerprint() const;
+};
+
+// Table index of an op type
+inline size_t functionUnitIndex(int opType) {
+    return static_cast<unsigned>(opType) < FU_OP_TYPES ? opType : FU_OP_TYPES;
+}
+
+// Load a pool from a text file of lines
+//     class NAME UNITS[w] pipelined|unpipelined   (UNITS followed by "w": per WIDTH)
+//     op TYPE|* CLASS LATENCY                      ("*": every op type without its own line)
+// with "#" comments; throws std::runtime_error naming the file and line if malformed
+FunctionUnitPool loadFunctionUnitPool(const std::string& path);
+
+#endif // FUNCTION_UNITS_H
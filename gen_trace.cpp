@@ -0,0 +1,31 @@
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "trace_gen.h"
+
+using namespace std;
+
+// Write a synthetic trace in the text trace format
+int main(int argc, char* argv[]) {
+    // Check for correct number of command-line arguments
+    TracePattern pattern;
+    if (argc < 3 || argc > 4 || !parseTracePattern(argv[1], pattern)) {
+        cerr << "Usage: " << argv[0] << " <chain|parallel|latency-mix|register-pressure> <length> [seed]" << endl;
+        return 1;
+    }
+    uint64_t length = stoull(argv[2]);
+    uint64_t seed = argc == 4 ? stoull(argv[3]) : 1;
+
+    TraceGenerator generator(pattern, seed);
+    for (uint64_t i = 0; i < length; i++) {
+        TraceRecord record = generator.next();
+        printf("%" PRIx64 " %d %d %d %d\n", record.pc, record.opType, record.destReg, record.src1Reg, record.src2Reg);
+    }
+
+    if (fflush(stdout) != 0) {
+        cerr << "Error: Could not write the trace" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,59 @@
+#ifndef INSTRUCTION_ARENA_H
+#define INSTRUCTION_ARENA_H
+
+#include <cassert>
+#include <vector>
+#include "processor_config.h"
+
+// InstructionArena: Stores every in-flight instruction exactly once. Pipeline latches, the
+// Issue Queue, the ROB and the execution units refer to instructions by small integer handles.
+// Hot scheduling state and the cold timing record live in separate arrays.
+class InstructionArena {
+private:
+    std::vector<InstructionState> m_state;   // Hot scheduling state, indexed by handle
+    std::vector<Instruction> m_record;       // Cold timing record, indexed by handle
+    std::vector<int> m_freeHandles;          // Unused handles (LIFO, so recently freed slots are reused first)
+
+public:
+    // Resize to capacity handles and release all of them
+    void reset(size_t capacity) {
+        m_state.assign(capacity, InstructionState());
+        m_record.assign(capacity, Instruction());
+        m_freeHandles.clear();
+        for (size_t i = capacity; i-- > 0;) {
+            m_freeHandles.push_back(i);
+        }
+    }
+
+    // Take an unused handle; its state is reset to defaults
+    int allocate() {
+        assert(!m_freeHandles.empty() && "instruction arena exhausted");
+        int handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        m_state[handle] = InstructionState();
+        return handle;
+    }
+
+    // Return a handle once its instruction has retired
+    void release(int handle) {
+        m_freeHandles.push_back(handle);
+    }
+
+    // Rebuild the free list after restoring a checkpoint: every handle not marked live is free
+    void rebuildFreeList(const std::vector<bool>& live) {
+        m_freeHandles.clear();
+        for (size_t i = m_state.size(); i-- > 0;) {
+            if (!live[i]) {
+                m_freeHandles.push_back(i);
+            }
+        }
+    }
+
+    InstructionState& state(int handle) { return m_state[handle]; }
+    const InstructionState& state(int handle) const { return m_state[handle]; }
+    Instruction& record(int handle) { return m_record[handle]; }
+    const Instruction& record(int handle) const { return m_record[handle]; }
+    size_t capacity() const { return m_state.size(); }
+};
+
+#endif // INSTRUCTION_ARENA_H
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "instruction_source.h"
+#include "compressed_source.h"
+
+// Discard records one at a time; sequential readers have no faster way to advance
+uint64_t InstructionSource::skip(uint64_t count) {
+    TraceRecord record;
+    uint64_t skipped = 0;
+    while (skipped < count && next(record)) {
+        skipped++;
+    }
+    return skipped;
+}
+
+// Constructor: Take ownership of an already opened text trace file
+TextInstructionSource::TextInstructionSource(FILE* traceFile) :
+    m_traceFile(traceFile)
+{
+}
+
+// Destructor: Close the trace file
+TextInstructionSource::~TextInstructionSource() {
+    if (m_traceFile) {
+        fclose(m_traceFile);
+    }
+}
+
+// Parse one "<PC> <op> <dest> <src1> <src2>" line from the trace file
+bool TextInstructionSource::next(TraceRecord& record) {
+    int ret = fscanf(m_traceFile, "%lx %d %d %d %d",
+                     &record.pc, &record.opType, &record.destReg, &record.src1Reg, &record.src2Reg);
+
+    // Check for end of trace file
+    return !(ret == EOF || ret < 5);
+}
+
+// Constructor: Map the binary trace into memory and validate its header
+BinaryInstructionSource::BinaryInstructionSource(const std::string& path) :
+    m_mapping(nullptr),
+    m_mappingSize(0),
+    m_records(nullptr),
+    m_recordCount(0),
+    m_position(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("could not open binary trace " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(BinaryTraceHeader)) {
+        close(fd);
+        throw std::runtime_error("binary trace " + path + " is too small");
+    }
+
+    m_mappingSize = st.st_size;
+    m_mapping = mmap(nullptr, m_mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m_mapping == MAP_FAILED) {
+        m_mapping = nullptr;
+        throw std::runtime_error("could not map binary trace " + path);
+    }
+
+    // Records are consumed front to back exactly once
+    madvise(m_mapping, m_mappingSize, MADV_SEQUENTIAL);
+
+    // Validate header
+    const BinaryTraceHeader* header = static_cast<const BinaryTraceHeader*>(m_mapping);
+    if (memcmp(header->magic, BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_SIZE) != 0 ||
+        header->version != BINARY_TRACE_VERSION ||
+        header->recordSize != sizeof(BinaryTraceRecord) ||
+        header->recordCount > (m_mappingSize - sizeof(BinaryTraceHeader)) / sizeof(BinaryTraceRecord)) {
+        munmap(m_mapping, m_mappingSize);
+        m_mapping = nullptr;
+        throw std::runtime_error("malformed binary trace " + path);
+    }
+
+    m_recordCount = header->recordCount;
+    m_records = reinterpret_cast<const BinaryTraceRecord*>(
+        static_cast<const char*>(m_mapping) + sizeof(BinaryTraceHeader));
+}
+
+// Destructor: Release the mapping
+BinaryInstructionSource::~BinaryInstructionSource() {
+    if (m_mapping) {
+        munmap(m_mapping, m_mappingSize);
+    }
+}
+
+// Return the next packed record widened to a TraceRecord
+bool BinaryInstructionSource::next(TraceRecord& record) {
+    if (m_position == m_recordCount) {
+        return false;
+    }
+
+    const BinaryTraceRecord& packed = m_records[m_position++];
+    record.pc = packed.pc;
+    record.opType = packed.opType;
+    record.destReg = packed.destReg;
+    record.src1Reg = packed.src1Reg;
+    record.src2Reg = packed.src2Reg;
+    return true;
+}
+
+// Advance the record index without touching the skipped records
+uint64_t BinaryInstructionSource::skip(uint64_t count) {
+    uint64_t skipped = std::min(count, m_recordCount - m_position);
+    m_position += skipped;
+    return skipped;
+}
+
+// Constructor: Start replaying from the first record
+MemoryInstructionSource::MemoryInstructionSource(const std::vector<TraceRecord>& records) :
+    m_records(records),
+    m_position(0)
+{
+}
+
+// Return the next record of the shared trace
+bool MemoryInstructionSource::next(TraceRecord& record) {
+    if (m_position == m_records.size()) {
+        return false;
+    }
+
+    record = m_records[m_position++];
+    return true;
+}
+
+// Advance the record index without touching the skipped records
+uint64_t MemoryInstructionSource::skip(uint64_t count) {
+    uint64_t skipped = std::min<uint64_t>(count, m_records.size() - m_position);
+    m_position += skipped;
+    return skipped;
+}
+
+// Check whether a file starts with the binary trace magic bytes
+bool isBinaryTrace(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    char magic[BINARY_TRACE_MAGIC_SIZE];
+    bool binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                  memcmp(magic, BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_SIZE) == 0;
+    fclose(file);
+    return binary;
+}
+
+// Open a trace file, selecting the reader from the file contents
+std::unique_ptr<InstructionSource> openInstructionSource(const std::string& path) {
+    FILE* traceFile = fopen(path.c_str(), "r");
+    if (!traceFile) {
+        return nullptr;
+    }
+
+    // Sniff the leading magic bytes, then rewind for the text reader
+    unsigned char magic[BINARY_TRACE_MAGIC_SIZE];
+    size_t length = fread(magic, 1, sizeof(magic), traceFile);
+    rewind(traceFile);
+
+    // Compressed traces are decoded on the fly, without a temporary copy
+    TraceCodec codec = detectTraceCodec(magic, length);
+    if (codec != TraceCodec::None) {
+        fclose(traceFile);
+        return std::unique_ptr<InstructionSource>(new CompressedInstructionSource(path, codec));
+    }
+
+    if (length == BINARY_TRACE_MAGIC_SIZE &&
+        memcmp(magic, BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_SIZE) == 0) {
+        fclose(traceFile);
+        return std::unique_ptr<InstructionSource>(new BinaryInstructionSource(path));
+    }
+
+    return std::unique_ptr<InstructionSource>(new TextInstructionSource(traceFile));
+}
+
+// Decode a whole trace into memory, using the same format detection as the simulator
+std::vector<TraceRecord> loadTraceRecords(const std::string& path) {
+    std::unique_ptr<InstructionSource> source = openInstructionSource(path);
+    if (!source) {
+        throw std::runtime_error("could not open trace file " + path);
+    }
+
+    std::vector<TraceRecord> records;
+    TraceRecord record;
+    while (source->next(record)) {
+        records.push_back(record);
+    }
+    return records;
+}
@@ -0,0 +1,91 @@
+#ifndef INSTRUCTION_SOURCE_H
+#define INSTRUCTION_SOURCE_H
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "trace_format.h"
+
+// InstructionSource: Supplies the dynamic instruction stream to the fetch stage
+class InstructionSource {
+public:
+    virtual ~InstructionSource() {}
+
+    // Read the next trace record; returns false once the trace is exhausted
+    virtual bool next(TraceRecord& record) = 0;
+
+    // Discard up to count records without simulating them; returns the number discarded.
+    // Readers with random access override this to jump ahead in constant time.
+    virtual uint64_t skip(uint64_t count);
+};
+
+// TextInstructionSource: Parses the original text trace format with fscanf
+class TextInstructionSource : public InstructionSource {
+private:
+    FILE* m_traceFile;  // Input trace file (owned)
+
+public:
+    explicit TextInstructionSource(FILE* traceFile);
+    ~TextInstructionSource();
+
+    bool next(TraceRecord& record) override;
+};
+
+// BinaryInstructionSource: Reads packed records directly out of a memory-mapped binary trace
+class BinaryInstructionSource : public InstructionSource {
+private:
+    void* m_mapping;                        // Base address of the mapped file
+    size_t m_mappingSize;                   // Size of the mapping in bytes
+    const BinaryTraceRecord* m_records;     // First record following the header
+    uint64_t m_recordCount;                 // Number of records in the trace
+    uint64_t m_position;                    // Index of the next record to return
+
+public:
+    explicit BinaryInstructionSource(const std::string& path);
+    ~BinaryInstructionSource();
+
+    bool next(TraceRecord& record) override;
+    uint64_t skip(uint64_t count) override;
+};
+
+// MemoryInstructionSource: Replays a trace already decoded into memory. The records are only read,
+// so any number of sources (one per simulated configuration) can share them across threads.
+class MemoryInstructionSource : public InstructionSource {
+private:
+    const std::vector<TraceRecord>& m_records;  // Decoded trace (owned by the caller)
+    size_t m_position;                          // Index of the next record to return
+
+public:
+    explicit MemoryInstructionSource(const std::vector<TraceRecord>& records);
+
+    bool next(TraceRecord& record) override;
+    uint64_t skip(uint64_t count) override;
+};
+
+// FunctionInstructionSource: Pulls records from a caller-supplied generator function, which
+// fills in the next record and returns false once the stream ends
+class FunctionInstructionSource : public InstructionSource {
+private:
+    std::function<bool(TraceRecord&)> m_generator;
+
+public:
+    explicit FunctionInstructionSource(std::function<bool(TraceRecord&)> generator) :
+        m_generator(std::move(generator))
+    {}
+
+    bool next(TraceRecord& record) override { return m_generator(record); }
+};
+
+// Check whether a file starts with the binary trace magic bytes
+bool isBinaryTrace(const std::string& path);
+
+// Open a trace file, selecting the reader from the file contents.
+// Returns nullptr if the file cannot be opened; throws on malformed binary traces.
+std::unique_ptr<InstructionSource> openInstructionSource(const std::string& path);
+
+// Decode a whole trace (any supported format) into memory; throws if it cannot be read
+std::vector<TraceRecord> loadTraceRecords(const std::string& path);
+
+#endif // INSTRUCTION_SOURCE_H
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "interval_estimator.h"
+
+// Ideal-schedule delays of the detailed pipeline: an instruction entering the window (rename) can
+// issue three cycles later, and retires two cycles after its result is ready
+#define SCHEDULE_ISSUE_DELAY 3
+#define SCHEDULE_RETIRE_DELAY 2
+
+// Smallest power of two holding count entries
+static uint64_t ringSize(uint64_t count) {
+    uint64_t size = 1;
+    while (size < count) {
+        size <<= 1;
+    }
+    return size;
+}
+
+// One rung per half octave (1, 2, 3, 4, 6, 8, 11, 16, ...), up to the first at or above maxWindow
+IntervalEstimator::IntervalEstimator(uint32_t maxWindow, const FunctionUnitPool* functionUnits) :
+    m_instructionCount(0) {
+    FunctionUnitPool defaultPool;
+    const FunctionUnitPool& pool = functionUnits ? *functionUnits : defaultPool;
+    for (size_t type = 0; type <= FU_OP_TYPES; type++) {
+        m_opLatency[type] = pool.opClass[type] < 0 ? -1 : pool.opLatency[type];
+    }
+
+    for (int step = 0; ; step++) {
+        uint64_t window = static_cast<uint64_t>(std::llround(std::pow(2.0, step / 2.0)));
+        if (!m_schedules.empty() && m_schedules.back().window == window) {
+            continue;
+        }
+
+        WindowSchedule schedule;
+        schedule.window = window;
+        schedule.committed.assign(ringSize(window), 0);
+        std::fill(schedule.registerReady, schedule.registerReady + ARF_SIZE, 0);
+        schedule.lastCommit = 0;
+        schedule.waiting = 0;
+        m_schedules.push_back(schedule);
+        if (window >= maxWindow) {
+            break;
+        }
+    }
+}
+
+// Schedule the instruction in every window: it enters once the instruction a window back has
+// committed, issues when its sources are ready, and commits in order
+void IntervalEstimator::add(const TraceRecord& record) {
+    int latency = m_opLatency[functionUnitIndex(record.opType)];
+    if (latency < 0) {
+        throw std::runtime_error("no function unit executes op type " + std::to_string(record.opType));
+    }
+    bool src1 = record.src1Reg >= 0 && record.src1Reg < ARF_SIZE;
+    bool src2 = record.src2Reg >= 0 && record.src2Reg < ARF_SIZE;
+    bool dest = record.destReg >= 0 && record.destReg < ARF_SIZE;
+    uint64_t index = m_instructionCount++;
+
+    for (WindowSchedule& schedule : m_schedules) {
+        uint64_t mask = schedule.committed.size() - 1;
+        uint64_t entered = index >= schedule.window ? schedule.committed[(index - schedule.window) & mask] : 0;
+        uint64_t earliest = entered + SCHEDULE_ISSUE_DELAY;
+
+        uint64_t issued = earliest;
+        if (src1) {
+            issued = std::max(issued, schedule.registerReady[record.src1Reg]);
+        }
+        if (src2) {
+            issued = std::max(issued, schedule.registerReady[record.src2Reg]);
+        }
+        schedule.waiting += issued - earliest;
+
+        uint64_t ready = issued + latency;
+        if (dest) {
+            schedule.registerReady[record.destReg] = ready;
+        }
+        schedule.lastCommit = std::max(schedule.lastCommit, ready + SCHEDULE_RETIRE_DELAY);
+        schedule.committed[index & mask] = schedule.lastCommit;
+    }
+}
+
+void IntervalEstimator::addAll(InstructionSource& source) {
+    TraceRecord record;
+    while (source.next(record)) {
+        add(record);
+    }
+}
+
+// Linear in log(window) between the surrounding rungs; clamped outside the ladder
+void IntervalEstimator::profileAt(double window, double& ipc, double& waiting) const {
+    size_t upper = 0;
+    while (upper + 1 < m_schedules.size() && m_schedules[upper].window < window) {
+        upper++;
+    }
+    size_t lower = upper > 0 && m_schedules[upper].window > window ? upper - 1 : upper;
+
+    auto rungIpc = [this](size_t rung) {
+        return m_schedules[rung].lastCommit ? static_cast<double>(m_instructionCount) / m_schedules[rung].lastCommit : 0.0;
+    };
+    auto rungWaiting = [this](size_t rung) {
+        return m_schedules[rung].lastCommit ? static_cast<double>(m_schedules[rung].waiting) / m_schedules[rung].lastCommit : 0.0;
+    };
+
+    double weight = 0.0;
+    if (lower != upper) {
+        double low = std::log(static_cast<double>(m_schedules[lower].window));
+        double high = std::log(static_cast<double>(m_schedules[upper].window));
+        weight = std::min(1.0, std::max(0.0, (std::log(window) - low) / (high - low)));
+    }
+    ipc = rungIpc(lower) + (rungIpc(upper) - rungIpc(lower)) * weight;
+    waiting = rungWaiting(lower) + (rungWaiting(upper) - rungWaiting(lower)) * weight;
+}
+
+double IntervalEstimator::ipc(const ProcessorParameters& config, const IntervalModelParameters& model) const {
+    if (config.width == 0 || config.robSize < config.width || config.iqSize < config.width) {
+        throw std::invalid_argument("pipeline deadlock: no stage can make progress "
+                                    "(IQ_SIZE and ROB_SIZE must be at least WIDTH)");
+    }
+    if (m_instructionCount == 0) {
+        return 0.0;
+    }
+
+    // The ROB window, shrunk while its waiting instructions overflow the IQ slack
+    double width = config.width;
+    double robWindow = std::max(1.0, config.robSize - model.widthDiscount * (width - 1));
+    double slack = model.iqScale * (config.iqSize - width) + model.iqWidthSlack * width;
+
+    double windowIpc, waiting;
+    profileAt(robWindow, windowIpc, waiting);
+    if (waiting > slack) {
+        double low = 1.0;
+        double high = robWindow;
+        profileAt(low, windowIpc, waiting);
+        if (waiting <= slack) {
+            for (int step = 0; step < 32; step++) {
+                double middle = std::sqrt(low * high);
+                profileAt(middle, windowIpc, waiting);
+                (waiting <= slack ? low : high) = middle;
+            }
+        }
+        profileAt(low, windowIpc, waiting);
+    }
+
+    // Cycles per instruction: a smooth maximum of the width and dataflow limits
+    double cpi = std::pow(std::pow(1.0 / width, model.blend) + std::pow(1.0 / windowIpc, model.blend), 1.0 / model.blend);
+    return 1.0 / cpi;
+}
+
+uint64_t IntervalEstimator::cycleCount(const ProcessorParameters& config, const IntervalModelParameters& model) const {
+    double estimate = ipc(config, model);
+    return estimate > 0.0 ? static_cast<uint64_t>(std::llround(m_instructionCount / estimate)) : 0;
+}
@@ -0,0 +1,75 @@
+#ifndef INTERVAL_ESTIMATOR_H
+#define INTERVAL_ESTIMATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "function_units.h"
+#include "instruction_source.h"
+#include "processor.h"
+
+// Constants of the interval model, fitted against detailed simulations of val_trace_gcc1 with the
+// default function-unit pool ("sim_sweep --calibrate" reports the error and refits them)
+struct IntervalModelParameters {
+    double iqScale;        // IQ entries per instruction waiting for operands
+    double iqWidthSlack;   // Extra waiting capacity per unit of WIDTH
+    double widthDiscount;  // ROB entries lost to group rename, per unit of WIDTH - 1
+    double blend;          // Exponent combining the width and dataflow limits (higher: sharper knee)
+
+    IntervalModelParameters() : iqScale(1.0), iqWidthSlack(0.25), widthDiscount(0.5), blend(4.0) {}
+};
+
+// IntervalEstimator: Analytical IPC estimates from one pass over a trace, without simulating.
+// The pass builds a window profile: for a geometric ladder of window sizes (two per octave, up to
+// the largest ROB of interest) it schedules the trace on an ideal machine of unlimited width whose
+// only limits are register dependences, op latencies and an in-order window of that many
+// instructions, with the detailed pipeline's fixed rename-to-issue and ready-to-retire delays.
+// Each rung records the resulting IPC and, by Little's law over the schedule, how many
+// instructions are waiting for operands beyond their first cycle in the issue queue.
+//
+// A configuration is then estimated in constant time. Its effective window is its ROB size,
+// shrunk to the largest window whose waiting instructions fit in the IQ slack (IQ_SIZE - WIDTH,
+// since the pipeline only dispatches into WIDTH free entries). The dataflow IPC of that window is
+// blended with the WIDTH limit. Function-unit counts are not modeled; only the pool's latencies
+// are used.
+class IntervalEstimator {
+private:
+    // Ideal schedule of the trace with one window size
+    struct WindowSchedule {
+        uint64_t window;                    // Instructions in flight at most
+        std::vector<uint64_t> committed;    // Ring of commit cycles of the latest instructions
+        uint64_t registerReady[ARF_SIZE];   // Cycle each architectural register's value is ready
+        uint64_t lastCommit;                // Commit cycle of the latest instruction
+        uint64_t waiting;                   // Instruction-cycles spent waiting for operands in the IQ
+    };
+
+    int m_opLatency[FU_OP_TYPES + 1];         // Latency of each op type (-1: no unit executes it)
+    std::vector<WindowSchedule> m_schedules;  // By ascending window size
+    uint64_t m_instructionCount;
+
+    // IPC and operand-waiting IQ occupancy at a window size, interpolated between rungs
+    void profileAt(double window, double& ipc, double& waiting) const;
+
+public:
+    // Profile windows up to maxWindow instructions with the latencies of a pool (nullptr: the
+    // default pool)
+    explicit IntervalEstimator(uint32_t maxWindow, const FunctionUnitPool* functionUnits = nullptr);
+
+    // Account for the next instruction of the trace; throws std::runtime_error if no function
+    // unit executes its op type
+    void add(const TraceRecord& record);
+
+    // Account for every remaining instruction of a source
+    void addAll(InstructionSource& source);
+
+    uint64_t instructionCount() const { return m_instructionCount; }
+
+    // Estimated IPC and cycles of a configuration for the instructions added so far; throws
+    // std::invalid_argument for configurations the pipeline cannot run (IQ_SIZE or ROB_SIZE
+    // smaller than WIDTH)
+    double ipc(const ProcessorParameters& config,
+               const IntervalModelParameters& model = IntervalModelParameters()) const;
+    uint64_t cycleCount(const ProcessorParameters& config,
+                        const IntervalModelParameters& model = IntervalModelParameters()) const;
+};
+
+#endif // INTERVAL_ESTIMATOR_H
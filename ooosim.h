@@ -0,0 +1,34 @@
+#ifndef OOOSIM_H
+#define OOOSIM_H
+
+// libooosim: Everything needed to drive simulations in-process.
+//
+//     GeneratedInstructionSource source(TracePattern::LatencyMix, 100000);
+//     CountingRetireSink retired;
+//     SimulationOptions options;
+//     options.retireSink = &retired;
+//
+//     ProcessorParameters config;
+//     config.robSize = 256; config.iqSize = 64; config.width = 4;
+//     std::unique_ptr<SimulationEngine> processor = makeProcessor(config, source, options);
+//     while (processor->runCycles(1000)) { /* inspect retiredCount(), cycleCount() */ }
+//
+// Instruction sources: openInstructionSource (text, binary or compressed trace files),
+// MemoryInstructionSource (a decoded vector), GeneratedInstructionSource (synthetic patterns),
+// FunctionInstructionSource (any generator function). Retire sinks: DiscardRetireSink,
+// CountingRetireSink, TextRetireLog / BinaryRetireLog, CallbackRetireSink and RetireSinkTee.
+// Processors borrow their source and sink, keep no global state and write nothing to stdout
+// during simulation, so any number can run on separate threads. BatchSimulator runs several
+// configurations over a single pass of one source; IntervalEstimator estimates the IPC of many
+// configurations from one pass without simulating them.
+
+#include "processor.h"
+#include "batch_simulator.h"
+#include "interval_estimator.h"
+#include "instruction_source.h"
+#include "retire_log.h"
+#include "pipeline_view.h"
+#include "sampling.h"
+#include "trace_gen.h"
+
+#endif // OOOSIM_H
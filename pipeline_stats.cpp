@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include "pipeline_stats.h"
+
+// Report labels, in enum order
+static const char* const STAGE_NAMES[STAGE_COUNT] = {
+    "Fetch", "Decode", "Rename", "RegRead", "Dispatch", "Issue", "Execute", "Retire"
+};
+static const char* const STALL_NAMES[STALL_REASON_COUNT] = {
+    "none", "input empty", "output full", "ROB full", "IQ full", "FUs full",
+    "operands not ready", "writeback full", "head not done", "trace end"
+};
+static const char* const ISSUE_CAUSE_NAMES[ISSUE_CAUSE_COUNT] = {
+    "Issued", "Function units full", "Operand dependencies", "ROB full (rename blocked)",
+    "Front-end latency", "Pipeline drain"
+};
+static const char* const RETIRE_CAUSE_NAMES[RETIRE_CAUSE_COUNT] = {
+    "Retired", "ROB empty", "Head waiting to issue", "Head executing"
+};
+static const char* const OCCUPANCY_NAMES[OCC_COUNT] = {
+    "ROB", "IQ", "Decode", "Rename", "RegRead", "Dispatch", "Executing", "Writeback"
+};
+
+// Constructor: Zero all counters
+PipelineStats::PipelineStats() :
+    issued(0),
+    waiting(0),
+    retired(0),
+    retireLoss(RETIRE_USED),
+    cycles(0)
+{
+    memset(stallCycles, 0, sizeof(stallCycles));
+    memset(issueSlots, 0, sizeof(issueSlots));
+    memset(retireSlots, 0, sizeof(retireSlots));
+    memset(capacity, 0, sizeof(capacity));
+    beginCycle();
+}
+
+// Start observing a new cycle
+void PipelineStats::beginCycle() {
+    std::fill(stageStall, stageStall + STAGE_COUNT, STALL_NONE);
+    issued = 0;
+    waiting = 0;
+    retired = 0;
+    retireLoss = RETIRE_USED;
+}
+
+// Fold the current cycle's observations into the counters
+void PipelineStats::endCycle(uint32_t width, uint64_t weight, bool drained) {
+    cycles += weight;
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        stallCycles[stage][stageStall[stage]] += weight;
+    }
+
+    // Issue slots: unused slots go to instructions stuck on operands first, then to whatever
+    // starved the IQ
+    uint32_t lost = width - issued;
+    issueSlots[ISSUE_USED] += issued * weight;
+    if (stageStall[STAGE_ISSUE] == STALL_EXEC_FULL) {
+        issueSlots[ISSUE_EXEC_FULL] += lost * weight;
+    }
+    else {
+        uint32_t dependent = std::min(lost, waiting);
+        issueSlots[ISSUE_DEPENDENCY] += dependent * weight;
+
+        IssueSlotCause starvation = drained ? ISSUE_DRAIN :
+                                    stageStall[STAGE_RENAME] == STALL_ROB_FULL ? ISSUE_ROB_FULL :
+                                    ISSUE_FRONTEND;
+        issueSlots[starvation] += (lost - dependent) * weight;
+    }
+
+    // Retire slots
+    retireSlots[RETIRE_USED] += retired * weight;
+    retireSlots[retired < width ? retireLoss : RETIRE_USED] += (width - retired) * weight;
+}
+
+// Print the stall, top-down and occupancy report
+void PipelineStats::print() const {
+    std::cout << "# === Stall Attribution (% of cycles) ===" << std::endl;
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        std::cout << "# " << std::left << std::setw(9) << STAGE_NAMES[stage] << std::right;
+        if (stallCycles[stage][STALL_NONE] == cycles) {
+            std::cout << "  never stalled";
+        }
+        for (int reason = 1; reason < STALL_REASON_COUNT; reason++) {
+            if (stallCycles[stage][reason]) {
+                std::cout << "  " << STALL_NAMES[reason] << " "
+                          << std::fixed << std::setprecision(1)
+                          << 100.0 * stallCycles[stage][reason] / cycles << "%";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    uint64_t issueTotal = 0;
+    uint64_t retireTotal = 0;
+    for (int cause = 0; cause < ISSUE_CAUSE_COUNT; cause++) {
+        issueTotal += issueSlots[cause];
+    }
+    for (int cause = 0; cause < RETIRE_CAUSE_COUNT; cause++) {
+        retireTotal += retireSlots[cause];
+    }
+
+    std::cout << "# === Top-Down Issue Slots ===========" << std::endl;
+    for (int cause = 0; cause < ISSUE_CAUSE_COUNT; cause++) {
+        std::cout << "# " << std::left << std::setw(30) << ISSUE_CAUSE_NAMES[cause] << std::right
+                  << " = " << std::fixed << std::setprecision(1)
+                  << std::setw(5) << (issueTotal ? 100.0 * issueSlots[cause] / issueTotal : 0.0) << "%" << std::endl;
+    }
+
+    std::cout << "# === Top-Down Retire Slots ==========" << std::endl;
+    for (int cause = 0; cause < RETIRE_CAUSE_COUNT; cause++) {
+        std::cout << "# " << std::left << std::setw(30) << RETIRE_CAUSE_NAMES[cause] << std::right
+                  << " = " << std::fixed << std::setprecision(1)
+                  << std::setw(5) << (retireTotal ? 100.0 * retireSlots[cause] / retireTotal : 0.0) << "%" << std::endl;
+    }
+
+    // Occupancy: mean, share of cycles empty and full, then the distribution in tenths of capacity
+    std::cout << "# === Occupancy =======================" << std::endl;
+    for (int structure = 0; structure < OCC_COUNT; structure++) {
+        const std::vector<uint64_t>& histogram = occupancy[structure];
+        uint32_t size = capacity[structure];
+        uint64_t total = 0;
+        double sum = 0.0;
+        uint64_t deciles[10] = {0};
+        for (size_t value = 0; value < histogram.size(); value++) {
+            total += histogram[value];
+            sum += static_cast<double>(value) * histogram[value];
+            size_t decile = size ? std::min<size_t>(9, value * 10 / size) : 0;
+            deciles[decile] += histogram[value];
+        }
+        if (total == 0) {
+            continue;
+        }
+
+        uint64_t empty = histogram.empty() ? 0 : histogram[0];
+        uint64_t full = size < histogram.size() ? histogram[size] : 0;
+        std::cout << "# " << std::left << std::setw(9) << OCCUPANCY_NAMES[structure] << std::right
+                  << " mean " << std::fixed << std::setprecision(1) << std::setw(6) << sum / total
+                  << " / " << std::setw(4) << size
+                  << "  empty " << std::setw(5) << 100.0 * empty / total << "%"
+                  << "  full " << std::setw(5) << 100.0 * full / total << "%"
+                  << "  |";
+        for (int decile = 0; decile < 10; decile++) {
+            std::cout << " " << std::setw(4) << 100.0 * deciles[decile] / total;
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef PIPELINE_STATS_H
+#define PIPELINE_STATS_H
+
+#include <cstdint>
+#include <vector>
+
+// Pipeline statistics are compiled in only when PIPELINE_STATS is defined (make STATS=1);
+// otherwise every hook expands to nothing and the simulator runs at full speed.
+#ifdef PIPELINE_STATS
+#define STATS_HOOK(...) __VA_ARGS__
+#else
+#define STATS_HOOK(...)
+#endif
+
+// Pipeline stages with stall attribution
+enum PipelineStage {
+    STAGE_FETCH,
+    STAGE_DECODE,
+    STAGE_RENAME,
+    STAGE_REGREAD,
+    STAGE_DISPATCH,
+    STAGE_ISSUE,
+    STAGE_EXECUTE,
+    STAGE_RETIRE,
+    STAGE_COUNT
+};
+
+// Why a stage moved fewer than WIDTH instructions in a cycle (the first limit it hit)
+enum StallReason {
+    STALL_NONE,           // Full width (or nothing left to do after the trace ended)
+    STALL_INPUT_EMPTY,    // Nothing (more) to take from the previous stage
+    STALL_OUTPUT_FULL,    // Next pipeline latch full
+    STALL_ROB_FULL,       // Fewer than WIDTH free ROB entries (rename)
+    STALL_IQ_FULL,        // Fewer than WIDTH free IQ entries, or IQ filled (dispatch)
+    STALL_EXEC_FULL,      // All function unit slots occupied (issue)
+    STALL_NOT_READY,      // Waiting instructions still lack operands (issue)
+    STALL_WRITEBACK_FULL, // Completions held back by a full writeback buffer (execute)
+    STALL_HEAD_NOT_DONE,  // ROB head has not completed (retire)
+    STALL_TRACE_END,      // Trace exhausted (fetch)
+    STALL_REASON_COUNT
+};
+
+// Top-down categories for lost issue slots
+enum IssueSlotCause {
+    ISSUE_USED,           // An instruction issued
+    ISSUE_EXEC_FULL,      // Function units full
+    ISSUE_DEPENDENCY,     // Instructions waiting in the IQ on operands
+    ISSUE_ROB_FULL,       // IQ starved because rename was blocked by a full ROB
+    ISSUE_FRONTEND,       // IQ starved by fetch/decode/rename/register-read latency
+    ISSUE_DRAIN,          // IQ starved after the trace ended
+    ISSUE_CAUSE_COUNT
+};
+
+// Top-down categories for lost retire slots
+enum RetireSlotCause {
+    RETIRE_USED,          // An instruction retired
+    RETIRE_ROB_EMPTY,     // Nothing in the ROB
+    RETIRE_HEAD_WAITING,  // ROB head not issued yet (operands or front of pipeline)
+    RETIRE_HEAD_EXECUTING,// ROB head issued but not written back
+    RETIRE_CAUSE_COUNT
+};
+
+// Occupancy-tracked structures
+enum OccupancyStructure {
+    OCC_ROB,
+    OCC_IQ,
+    OCC_DECODE,
+    OCC_RENAME,
+    OCC_REGREAD,
+    OCC_DISPATCH,
+    OCC_EXECUTING,
+    OCC_WRITEBACK,
+    OCC_COUNT
+};
+
+// PipelineStats: Per-cycle stall reasons, top-down slot accounting and occupancy histograms.
+// Every counter is weighted by the number of cycles the observation stands for, so cycles
+// jumped over by idle-cycle skipping (which would repeat the observed cycle exactly) count too.
+struct PipelineStats {
+    // Observations for the cycle being evaluated
+    StallReason stageStall[STAGE_COUNT];
+    uint32_t issued;      // Instructions issued
+    uint32_t waiting;     // Instructions left in the IQ after issue
+    uint32_t retired;     // Instructions retired
+    RetireSlotCause retireLoss;  // Why retirement stopped short of WIDTH
+
+    // Accumulated counters
+    uint64_t cycles;
+    uint64_t stallCycles[STAGE_COUNT][STALL_REASON_COUNT];
+    uint64_t issueSlots[ISSUE_CAUSE_COUNT];
+    uint64_t retireSlots[RETIRE_CAUSE_COUNT];
+    std::vector<uint64_t> occupancy[OCC_COUNT];  // Cycles spent at each occupancy
+    uint32_t capacity[OCC_COUNT];                // Size of each structure
+
+    PipelineStats();
+
+    // Set the structure sizes used by the occupancy report
+    void setCapacity(OccupancyStructure structure, uint32_t size) { capacity[structure] = size; }
+
+    // Start observing a new cycle
+    void beginCycle();
+
+    // Fold the current cycle's stall and slot observations into the counters, standing for
+    // weight cycles. drained: the trace has ended and no instruction is left before the IQ.
+    void endCycle(uint32_t width, uint64_t weight, bool drained);
+
+    // Record the occupancy of a structure at the end of a cycle standing for weight cycles
+    void recordOccupancy(OccupancyStructure structure, size_t value, uint64_t weight) {
+        if (value >= occupancy[structure].size()) {
+            occupancy[structure].resize(value + 1, 0);
+        }
+        occupancy[structure][value] += weight;
+    }
+
+    // Print the stall, top-down and occupancy report
+    void print() const;
+};
+
+#endif // PIPELINE_STATS_H
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <cinttypes>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include "pipeline_view.h"
+
+// Stages in pipeline order, named as in the per-instruction output
+#define PIPELINE_VIEW_STAGES 9
+static const char* const STAGE_NAMES[PIPELINE_VIEW_STAGES] = {
+    "FE", "DE", "RN", "RR", "DI", "IS", "EX", "WB", "RT"
+};
+
+// Begin cycle and duration of each stage of a record, in pipeline order
+static void stageTimes(const Instruction& inst, int64_t begin[], int64_t duration[]) {
+    const int beginCycles[PIPELINE_VIEW_STAGES] = {
+        inst.fetchCycle, inst.decodeCycle, inst.renameCycle, inst.regReadCycle, inst.dispatchCycle,
+        inst.issueCycle, inst.executeCycle, inst.writebackCycle, inst.retireCycle
+    };
+    const int durations[PIPELINE_VIEW_STAGES] = {
+        inst.fetchDuration, inst.decodeDuration, inst.renameDuration, inst.regReadDuration,
+        inst.dispatchDuration, inst.issueDuration, inst.executeDuration, inst.writebackDuration,
+        inst.retireDuration
+    };
+    for (int stage = 0; stage < PIPELINE_VIEW_STAGES; stage++) {
+        begin[stage] = beginCycles[stage];
+        duration[stage] = durations[stage];
+    }
+}
+
+// First cycle after the instruction left the pipeline
+static inline int64_t retireEnd(const Instruction& inst) {
+    return static_cast<int64_t>(inst.retireCycle) + inst.retireDuration;
+}
+
+PipelineViewCapture::PipelineViewCapture(const std::vector<PipelineViewWindow>& windows, size_t limit) :
+    m_windows(windows),
+    m_limit(limit),
+    m_head(0),
+    m_dropped(0)
+{
+    if (m_limit == 0) {
+        throw std::invalid_argument("pipeline view limit must be at least 1");
+    }
+}
+
+// Check whether a record falls in any capture window
+bool PipelineViewCapture::inWindow(const Instruction& inst) const {
+    if (m_windows.empty()) {
+        return true;
+    }
+
+    for (const PipelineViewWindow& window : m_windows) {
+        if (window.byCycle) {
+            // Any overlap between the window and the instruction's lifetime
+            if (static_cast<uint64_t>(inst.fetchCycle) <= window.last &&
+                static_cast<uint64_t>(retireEnd(inst)) > window.first) {
+                return true;
+            }
+        }
+        else if (inst.sequenceNum >= window.first && inst.sequenceNum <= window.last) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Keep the record if it falls in a window, overwriting the oldest capture once the ring is full
+void PipelineViewCapture::retire(const Instruction& inst) {
+    if (!inWindow(inst)) {
+        return;
+    }
+
+    if (m_ring.size() < m_limit) {
+        m_ring.push_back(inst);
+        return;
+    }
+    m_ring[m_head] = inst;
+    m_head = (m_head + 1) % m_limit;
+    m_dropped++;
+}
+
+// Captured records in retirement order
+std::vector<Instruction> PipelineViewCapture::captured() const {
+    std::vector<Instruction> records;
+    records.reserve(m_ring.size());
+    records.insert(records.end(), m_ring.begin() + m_head, m_ring.end());
+    records.insert(records.end(), m_ring.begin(), m_ring.begin() + m_head);
+    return records;
+}
+
+// Kanata log: commands grouped by cycle, each group preceded by the cycle advance
+void PipelineViewCapture::writeKonata(FILE* file) const {
+    std::vector<Instruction> records = captured();
+
+    // One event per stage begin plus the final retirement, ordered by cycle, then instruction
+    struct Event {
+        int64_t cycle;
+        uint32_t id;    // Index of the record in the capture
+        uint32_t step;  // Stage index, PIPELINE_VIEW_STAGES for retirement
+    };
+    std::vector<Event> events;
+    events.reserve(records.size() * (PIPELINE_VIEW_STAGES + 1));
+    for (uint32_t id = 0; id < records.size(); id++) {
+        int64_t begin[PIPELINE_VIEW_STAGES];
+        int64_t duration[PIPELINE_VIEW_STAGES];
+        stageTimes(records[id], begin, duration);
+        for (uint32_t stage = 0; stage < PIPELINE_VIEW_STAGES; stage++) {
+            events.push_back({begin[stage], id, stage});
+        }
+        events.push_back({retireEnd(records[id]), id, PIPELINE_VIEW_STAGES});
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.cycle < b.cycle;
+    });
+
+    fprintf(file, "Kanata\t0004\n");
+    int64_t cycle = events.empty() ? 0 : events.front().cycle;
+    fprintf(file, "C=\t%" PRId64 "\n", cycle);
+
+    uint64_t retired = 0;
+    for (const Event& event : events) {
+        if (event.cycle != cycle) {
+            fprintf(file, "C\t%" PRId64 "\n", event.cycle - cycle);
+            cycle = event.cycle;
+        }
+
+        const Instruction& inst = records[event.id];
+        if (event.step == 0) {
+            fprintf(file, "I\t%u\t%" PRIu64 "\t0\n", event.id, inst.sequenceNum);
+            fprintf(file, "L\t%u\t0\t%" PRIx64 ": fu{%d} src{%d,%d} dst{%d}\n", event.id, inst.pc,
+                    inst.opType, inst.src1Reg, inst.src2Reg, inst.destReg);
+        }
+        if (event.step < PIPELINE_VIEW_STAGES) {
+            fprintf(file, "S\t%u\t0\t%s\n", event.id, STAGE_NAMES[event.step]);
+        }
+        else {
+            fprintf(file, "E\t%u\t0\t%s\n", event.id, STAGE_NAMES[PIPELINE_VIEW_STAGES - 1]);
+            fprintf(file, "R\t%u\t%" PRIu64 "\t0\n", event.id, retired++);
+        }
+    }
+}
+
+// Chrome Trace Event JSON: one complete ("X") event per stage. Each instruction is drawn on the
+// lowest lane free since its fetch, so lanes show the instructions in flight.
+void PipelineViewCapture::writeChrome(FILE* file) const {
+    std::vector<Instruction> records = captured();
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"pipeline\"}}");
+
+    // Lanes in use, by the cycle they become free, and lanes already released
+    typedef std::pair<int64_t, uint32_t> BusyLane;
+    std::priority_queue<BusyLane, std::vector<BusyLane>, std::greater<BusyLane>> busyLanes;
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> freeLanes;
+    uint32_t laneCount = 0;
+
+    for (const Instruction& inst : records) {
+        // Records arrive in program order, so fetch cycles never decrease
+        while (!busyLanes.empty() && busyLanes.top().first <= inst.fetchCycle) {
+            freeLanes.push(busyLanes.top().second);
+            busyLanes.pop();
+        }
+        uint32_t lane = laneCount;
+        if (freeLanes.empty()) {
+            laneCount++;
+        }
+        else {
+            lane = freeLanes.top();
+            freeLanes.pop();
+        }
+        busyLanes.push(BusyLane(retireEnd(inst), lane));
+
+        int64_t begin[PIPELINE_VIEW_STAGES];
+        int64_t duration[PIPELINE_VIEW_STAGES];
+        stageTimes(inst, begin, duration);
+        for (int stage = 0; stage < PIPELINE_VIEW_STAGES; stage++) {
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"pipeline\",\"ph\":\"X\",\"ts\":%" PRId64
+                    ",\"dur\":%" PRId64 ",\"pid\":0,\"tid\":%u,\"args\":{\"seq\":%" PRIu64
+                    ",\"pc\":\"%" PRIx64 "\",\"fu\":%d}}",
+                    STAGE_NAMES[stage], begin[stage], duration[stage], lane, inst.sequenceNum,
+                    inst.pc, inst.opType);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+}
+
+// Write the captured timelines
+void PipelineViewCapture::write(const std::string& path, PipelineViewFormat format) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        throw std::runtime_error("could not create pipeline view " + path);
+    }
+
+    if (format == PipelineViewFormat::Konata) {
+        writeKonata(file);
+    }
+    else {
+        writeChrome(file);
+    }
+
+    bool failed = ferror(file) != 0;
+    if (fclose(file) != 0 || failed) {
+        throw std::runtime_error("failed writing pipeline view " + path);
+    }
+}
+
+// Parse a "FIRST:LAST" window
+PipelineViewWindow parsePipelineViewWindow(const std::string& text, bool byCycle) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos) {
+        throw std::invalid_argument("window must be FIRST:LAST");
+    }
+
+    PipelineViewWindow window;
+    window.byCycle = byCycle;
+    window.first = std::stoull(text.substr(0, colon));
+    window.last = std::stoull(text.substr(colon + 1));
+    if (window.last < window.first) {
+        throw std::invalid_argument("window " + text + " ends before it starts");
+    }
+    return window;
+}
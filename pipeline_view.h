@@ -0,0 +1,61 @@
+#ifndef PIPELINE_VIEW_H
+#define PIPELINE_VIEW_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "retire_log.h"
+
+// Default number of instructions kept by a pipeline view capture
+#define PIPELINE_VIEW_DEFAULT_LIMIT 100000
+
+// Pipeline view output formats
+enum class PipelineViewFormat {
+    Konata,  // Kanata log (version 0004) for the Konata pipeline viewer
+    Chrome   // Chrome Trace Event JSON (chrome://tracing, Perfetto); one cycle per microsecond
+};
+
+// Capture Window: inclusive range of sequence numbers or cycles
+struct PipelineViewWindow {
+    bool byCycle;    // Range of cycles (any overlap with an instruction's lifetime) instead of sequence numbers
+    uint64_t first;  // First sequence number or cycle
+    uint64_t last;   // Last sequence number or cycle
+};
+
+// PipelineViewCapture: Keeps the timing records of retired instructions that fall in one of the
+// capture windows, in a ring buffer holding the most recent `limit` of them, and writes their
+// stage timelines for a pipeline viewer. Instructions outside every window cost two comparisons
+// per window at retirement.
+class PipelineViewCapture : public RetireSink {
+private:
+    std::vector<PipelineViewWindow> m_windows;  // Capture windows (everything if empty)
+    std::vector<Instruction> m_ring;            // Captured records, oldest at m_head once full
+    size_t m_limit;                             // Ring capacity
+    size_t m_head;                              // Oldest record once the ring has wrapped
+    uint64_t m_dropped;                         // Captured records overwritten by newer ones
+
+    bool inWindow(const Instruction& inst) const;
+
+    // Captured records in retirement order
+    std::vector<Instruction> captured() const;
+
+    void writeKonata(FILE* file) const;
+    void writeChrome(FILE* file) const;
+
+public:
+    PipelineViewCapture(const std::vector<PipelineViewWindow>& windows, size_t limit);
+
+    void retire(const Instruction& inst) override;
+    void flush() override {}
+
+    // Write the captured timelines; throws if the file cannot be written
+    void write(const std::string& path, PipelineViewFormat format) const;
+
+    uint64_t capturedCount() const { return m_ring.size(); }
+    uint64_t droppedCount() const { return m_dropped; }
+};
+
+// Parse a "FIRST:LAST" window; throws std::invalid_argument if malformed
+PipelineViewWindow parsePipelineViewWindow(const std::string& text, bool byCycle);
+
+#endif // PIPELINE_VIEW_H
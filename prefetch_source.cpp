@@ -0,0 +1,61 @@
+#include "prefetch_source.h"
+
+// Constructor: Start the producer thread on the wrapped source
+PrefetchInstructionSource::PrefetchInstructionSource(
+    std::unique_ptr<InstructionSource> source,
+    size_t ringSize
+) :
+    m_source(std::move(source)),
+    m_ring(ringSize),
+    m_producerDone(false),
+    m_stopRequested(false)
+{
+    m_producer = std::thread(&PrefetchInstructionSource::producerLoop, this);
+}
+
+// Destructor: Stop and join the producer thread
+PrefetchInstructionSource::~PrefetchInstructionSource() {
+    m_stopRequested.store(true, std::memory_order_relaxed);
+    if (m_producer.joinable()) {
+        m_producer.join();
+    }
+}
+
+// Producer thread: Decode records until the trace ends or the consumer goes away
+void PrefetchInstructionSource::producerLoop() {
+    try {
+        TraceRecord record;
+        while (!m_stopRequested.load(std::memory_order_relaxed) && m_source->next(record)) {
+            // Wait for the fetch stage to free a slot
+            while (!m_ring.tryPush(record)) {
+                if (m_stopRequested.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        }
+    }
+    catch (...) {
+        m_producerError = std::current_exception();
+    }
+
+    m_producerDone.store(true, std::memory_order_release);
+}
+
+// Pop the next decoded record, waiting for the producer if it has fallen behind
+bool PrefetchInstructionSource::next(TraceRecord& record) {
+    while (!m_ring.tryPop(record)) {
+        if (m_producerDone.load(std::memory_order_acquire)) {
+            // Records pushed before the done flag are visible now; drain them first
+            if (m_ring.tryPop(record)) {
+                return true;
+            }
+            if (m_producerError) {
+                std::rethrow_exception(m_producerError);
+            }
+            return false;
+        }
+        std::this_thread::yield();
+    }
+    return true;
+}
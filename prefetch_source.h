@@ -0,0 +1,37 @@
+#ifndef PREFETCH_SOURCE_H
+#define PREFETCH_SOURCE_H
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include "instruction_source.h"
+#include "spsc_ring.h"
+
+// Default number of decoded records buffered ahead of the fetch stage
+#define PREFETCH_RING_SIZE 65536
+
+// PrefetchInstructionSource: Decodes trace records on a producer thread into a lock-free ring,
+// so trace I/O and parsing overlap with pipeline evaluation. The record order is unchanged.
+class PrefetchInstructionSource : public InstructionSource {
+private:
+    std::unique_ptr<InstructionSource> m_source;  // Underlying reader, used only by the producer thread
+    SpscRing<TraceRecord> m_ring;                 // Decoded records waiting for the fetch stage
+    std::atomic<bool> m_producerDone;             // Producer pushed its last record
+    std::atomic<bool> m_stopRequested;            // Consumer is shutting down early
+    std::exception_ptr m_producerError;           // Error raised while decoding, rethrown to the consumer
+    std::thread m_producer;                       // Producer thread
+
+    void producerLoop();
+
+public:
+    explicit PrefetchInstructionSource(
+        std::unique_ptr<InstructionSource> source,
+        size_t ringSize = PREFETCH_RING_SIZE
+    );
+    ~PrefetchInstructionSource();
+
+    bool next(TraceRecord& record) override;
+};
+
+#endif // PREFETCH_SOURCE_H
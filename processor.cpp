@@ -1,30 +1,69 @@
+#include <algorithm>
+#include <cassert>
 #include <climits>
 #include <iomanip>
 #include <iostream>
+#include <stdexcept>
 #include "processor.h"
+#include "retire_log.h"
 
-// Constructor: Initialize the out-of-order processor with configuration and trace file
-OutOfOrderProcessor::OutOfOrderProcessor(
+// Constructor: Initialize the out-of-order processor with configuration and instruction source
+template <size_t Width, size_t RobSize, size_t IqSize>
+OutOfOrderProcessor<Width, RobSize, IqSize>::OutOfOrderProcessor(
     const ProcessorParameters& config, 
-    FILE* traceFile
+    InstructionSource& source,
+    const SimulationOptions& options
 ) : 
     m_config(config),
-    m_traceFile(traceFile),
-    m_reorderBuffer(config.robSize),
-    m_renameTable(ARF_SIZE),
-    m_issueQueue(config.iqSize),
+    m_options(options),
+    m_source(source),
     m_robHead(0),
     m_robTail(0),
+    m_robOccupancy(0),
+    m_renameTable(ARF_SIZE),
+    m_iqOccupancy(0),
+    m_wheelMask(0),
+    m_executingCount(0),
+    m_pool(config.functionUnits ? *config.functionUnits : FunctionUnitPool()),
+    m_unitClassCount(0),
     m_instructionCount(0),
+    m_retiredCount(0),
     m_cycleCount(0),
-    m_simulationComplete(false)
+    m_simulationComplete(false),
+    m_progress(false)
 {
+    // A specialization only runs the configuration it was compiled for
+    if ((Width && config.width != Width) || (RobSize && config.robSize != RobSize) ||
+        (IqSize && config.iqSize != IqSize)) {
+        throw std::invalid_argument("configuration does not match the specialized engine");
+    }
+
+    // The select logic keeps per-class counters for at most FU_MAX_CLASSES classes
+    if (m_pool.classes.empty() || m_pool.classes.size() > FU_MAX_CLASSES) {
+        throw std::invalid_argument("function unit pool must have 1 to " + std::to_string(FU_MAX_CLASSES) + " classes");
+    }
+    for (size_t type = 0; type <= FU_OP_TYPES; type++) {
+        if (m_pool.opClass[type] >= static_cast<int>(m_pool.classes.size()) ||
+            m_pool.opLatency[type] < 1 || m_pool.opLatency[type] > FU_MAX_LATENCY) {
+            throw std::invalid_argument("function unit pool has an invalid class or latency");
+        }
+    }
+    for (size_t unitClass = 0; unitClass < m_pool.classes.size(); unitClass++) {
+        if (m_pool.units(unitClass, width()) == 0) {
+            throw std::invalid_argument("function unit class " + m_pool.classes[unitClass].name + " has no units");
+        }
+    }
+
     // Initialize processor structures to their starting state
     initializeStructures();
 }
 
 // Reset all processor pipeline and tracking structures to their initial state
-void OutOfOrderProcessor::initializeStructures() {
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::initializeStructures() {
+    // Room for every ROB entry plus the decode (up to 2 * width - 1) and rename (width) buffers
+    m_arena.reset(robSize() + 3 * width());
+
     // Clear all pipeline buffers
     m_decodeBuffer.clear();
     m_renameBuffer.clear();
@@ -35,117 +74,247 @@ void OutOfOrderProcessor::initializeStructures() {
     // Reset Reorder Buffer to initial state
     m_robHead = 0;
     m_robTail = 0;
-    std::fill(m_reorderBuffer.begin(), m_reorderBuffer.end(), ReorderBufferEntry());
-    m_reorderBuffer.resize(m_config.robSize);
+    m_robOccupancy = 0;
+    resetStorage(m_reorderBuffer, robSize());
     
     // Reset Rename Table to initial state
     std::fill(m_renameTable.begin(), m_renameTable.end(), RenameTableEntry());
     m_renameTable.resize(ARF_SIZE);
     
     // Reset Issue Queue to initial state
-    std::fill(m_issueQueue.begin(), m_issueQueue.end(), IssueQueueEntry());
-    m_issueQueue.resize(m_config.iqSize);
+    resetStorage(m_issueQueue, iqSize());
+    m_iqOccupancy = 0;
+
+    // Every Issue Queue slot starts out free
+    m_iqFreeSlots = decltype(m_iqFreeSlots)();
+    for (size_t i = 0; i < iqSize(); i++) {
+        m_iqFreeSlots.push(i);
+    }
+
+    // Reset Wakeup Network
+    m_wakeupLists.assign(robSize(), std::vector<int>());
+
+    // Reset execution units: a wheel longer than the longest latency, and every unit free
+    m_completionWheel.assign(roundUpPowerOfTwo(m_pool.maxLatency() + 1), std::vector<ExecutionEntry>());
+    m_wheelMask = m_completionWheel.size() - 1;
+    m_completedExecutions.clear();
+    m_executingCount = 0;
+
+    // Function-unit lookup tables
+    m_unitClassCount = m_pool.classes.size();
+    for (size_t unitClass = 0; unitClass < m_unitClassCount; unitClass++) {
+        m_unitLimit[unitClass] = m_pool.units(unitClass, width());
+        m_unitsBusy[unitClass] = 0;
+        m_unitReleased[unitClass] = m_pool.classes[unitClass].pipelined ? 0 : 1;
+    }
+
+    // Reset select state
+    m_readyBits.resize(robSize());
+    m_newIssueQueueSlots.clear();
+
+    // Structure sizes for the occupancy report
+    STATS_HOOK(
+        m_stats.setCapacity(OCC_ROB, robSize());
+        m_stats.setCapacity(OCC_IQ, iqSize());
+        m_stats.setCapacity(OCC_DECODE, 2 * width() - 1);
+        m_stats.setCapacity(OCC_RENAME, width());
+        m_stats.setCapacity(OCC_REGREAD, width());
+        m_stats.setCapacity(OCC_DISPATCH, width());
+        m_stats.setCapacity(OCC_EXECUTING, m_pool.capacity(width()));
+        m_stats.setCapacity(OCC_WRITEBACK, width() * WRITEBACK_LATCH_FACTOR);
+    )
 }
 
 // Main simulation loop: Execute all pipeline stages for each cycle
-void OutOfOrderProcessor::simulate() {
-    do {   
-        // Execute pipeline stages in reverse order to model dependencies
-        retireStage();      // Commit completed instructions
-        writebackStage();   // Complete instruction execution
-        executeStage();     // Process instructions in execution
-        issueStage();       // Select instructions for execution
-        dispatchStage();    // Prepare instructions for issue
-        registerReadStage();// Read source register values
-        renameStage();      // Allocate rename resources
-        decodeStage();      // Decode fetched instructions
-        fetchStage();       // Fetch new instructions
-    } while (advanceCycle());
-}
-
-// Fetch stage: Read new instructions from trace file into decode buffer
-void OutOfOrderProcessor::fetchStage() {
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::simulate() {
+    while (stepCycle()) {
+    }
+}
+
+// Evaluate all pipeline stages for one cycle; returns false once no instruction is left in flight
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::stepCycle() {
+    return evaluateCycle(UINT64_MAX);
+}
+
+// Evaluate one cycle, letting an idle stretch advance the cycle count up to cycleLimit at most
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::evaluateCycle(uint64_t cycleLimit) {
+    // A finished run stays finished; further steps must not count cycles
+    if (isFinished()) {
+        return false;
+    }
+
+    m_progress = false;
+    STATS_HOOK(uint64_t firstCycle = m_cycleCount; m_stats.beginCycle();)
+
+    // Execute pipeline stages in reverse order to model dependencies
+    retireStage();      // Commit completed instructions
+    writebackStage();   // Complete instruction execution
+    executeStage();     // Process instructions in execution
+    issueStage();       // Select instructions for execution
+    dispatchStage();    // Prepare instructions for issue
+    registerReadStage();// Read source register values
+    renameStage();      // Allocate rename resources
+    decodeStage();      // Decode fetched instructions
+    fetchStage();       // Fetch new instructions
+
+    // Nothing changed: every cycle up to the next completion would repeat this one
+    if (!m_progress) {
+        skipIdleCycles(cycleLimit);
+    }
+
+    // A skipped stretch repeats this cycle, so the observations stand for all of it
+    STATS_HOOK(recordCycleStats(m_cycleCount - firstCycle + 1);)
+
+    return advanceCycle();
+}
+
+// Simulate until at least count instructions have retired. On return the cycle count is one past
+// the cycle in which the count was reached; returns false if the trace drained before that.
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::runUntilRetired(uint64_t count) {
+    while (m_retiredCount < count) {
+        if (!stepCycle()) {
+            return m_retiredCount >= count;
+        }
+    }
+    return true;
+}
+
+// Simulate until the cycle count reaches cycle exactly; an idle stretch crossing it is cut short,
+// since its cycles are all identical. Returns false if the pipeline drained before that.
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::runUntilCycle(uint64_t cycle) {
+    while (m_cycleCount < cycle) {
+        if (!evaluateCycle(cycle)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Simulate exactly count more cycles. Returns false if the pipeline drained before that.
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::runCycles(uint64_t count) {
+    return runUntilCycle(m_cycleCount + count);
+}
+
+// Fetch stage: Read new instructions from the instruction source into decode buffer
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::fetchStage() {
     // Prevent fetching if decode buffer is full
-    if (m_decodeBuffer.size() >= m_config.width) {
+    if (m_decodeBuffer.size() >= width()) {
+        STATS_HOOK(m_stats.stageStall[STAGE_FETCH] = STALL_OUTPUT_FULL;)
         return;
     }
 
-    // Read instructions from trace file
-    for (size_t i = 0; i < m_config.width; i++) {
-        uint64_t pc;
-        int opType, dest, src1, src2;
+    // Read instructions from the trace
+    for (size_t i = 0; i < width(); i++) {
+        TraceRecord record;
         
-        // Attempt to read instruction from trace file
-        int ret = fscanf(m_traceFile, "%lx %d %d %d %d", &pc, &opType, &dest, &src1, &src2);
-        
-        // Check for end of trace file
-        if (ret == EOF || ret < 5) {
+        // Check for end of trace
+        if (!m_source.next(record)) {
+            STATS_HOOK(m_stats.stageStall[STAGE_FETCH] = STALL_TRACE_END;)
+            m_progress |= !m_simulationComplete;
             m_simulationComplete = true;
             return;
         }
 
-        // Create and add instruction to decode buffer
-        Instruction instruction = createInstruction(
-            pc, opType, dest, src1, src2, m_instructionCount++
+        // Every operation needs a function unit that can execute it
+        size_t opIndex = functionUnitIndex(record.opType);
+        if (m_pool.opClass[opIndex] < 0) {
+            throw std::runtime_error("no function unit executes op type " + std::to_string(record.opType));
+        }
+
+        // Create the instruction in the arena and add its handle to the decode buffer
+        int handle = m_arena.allocate();
+        Instruction& instruction = m_arena.record(handle);
+        instruction = createInstruction(
+            record.pc, record.opType, record.destReg, record.src1Reg, record.src2Reg,
+            m_instructionCount++
         );
         
-        // Record fetch cycle information
+        // Record fetch cycle information; the decode stage sees it next cycle
         instruction.fetchCycle = m_cycleCount;
         instruction.fetchDuration = 1;
+        instruction.decodeCycle = m_cycleCount + 1;
+
+        // Copy the fields used by the scheduling loops into the hot state
+        InstructionState& state = m_arena.state(handle);
+        state.fetchCycle = instruction.fetchCycle;
+        state.opType = record.opType;
+        state.unitClass = m_pool.opClass[opIndex];
+        state.latency = m_pool.opLatency[opIndex];
+        state.destReg = record.destReg;
+        state.src1Reg = record.src1Reg;
+        state.src2Reg = record.src2Reg;
         
-        m_decodeBuffer.push_back(instruction);
+        m_decodeBuffer.push_back(handle);
+        m_progress = true;
     }
 }
 
 // Decode stage: Prepare instructions for renaming
-void OutOfOrderProcessor::decodeStage() {
-    // Mark decode cycle for new instructions
-    for (auto& inst : m_decodeBuffer) {
-        if (inst.decodeCycle == -1) {
-            inst.decodeCycle = m_cycleCount;
-        }
-    }
-    
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::decodeStage() {
     // Check if rename buffer has space
-    if (m_renameBuffer.size() == m_config.width) return;
+    if (m_renameBuffer.size() == width()) {
+        STATS_HOOK(m_stats.stageStall[STAGE_DECODE] = STALL_OUTPUT_FULL;)
+        return;
+    }
 
     // Move instructions from decode buffer to rename buffer
-    while (!m_decodeBuffer.empty() && m_renameBuffer.size() < m_config.width) {
-        Instruction inst = m_decodeBuffer.front();        
+    STATS_HOOK(size_t moved = 0;)
+    while (!m_decodeBuffer.empty() && m_renameBuffer.size() < width()) {
+        STATS_HOOK(moved++;)
+        int handle = m_decodeBuffer.front();
+        Instruction& inst = m_arena.record(handle);
         inst.decodeDuration = m_cycleCount - inst.decodeCycle + 1;
-        m_renameBuffer.push_back(inst);
+        inst.renameCycle = m_cycleCount + 1;
+        m_renameBuffer.push_back(handle);
         m_decodeBuffer.pop_front();
+        m_progress = true;
     }
+
+    STATS_HOOK(
+        if (moved < width()) {
+            m_stats.stageStall[STAGE_DECODE] = m_decodeBuffer.empty() ? STALL_INPUT_EMPTY : STALL_OUTPUT_FULL;
+        }
+    )
 }
 
 // Rename stage: Allocate rename resources and update rename table
-void OutOfOrderProcessor::renameStage() {
-    // Mark rename cycle for new instructions
-    for (auto& inst : m_renameBuffer) {
-        if (inst.renameCycle == -1) {
-            inst.renameCycle = m_cycleCount;
-        }
-    }
-    
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::renameStage() {
     // Check if ROB and register read buffer have space
-    if (isReorderBufferFull() || m_registerReadBuffer.size() == m_config.width)
+    if (isReorderBufferFull() || m_registerReadBuffer.size() == width()) {
+        STATS_HOOK(m_stats.stageStall[STAGE_RENAME] = isReorderBufferFull() ? STALL_ROB_FULL : STALL_OUTPUT_FULL;)
         return;
+    }
 
-    while (!m_renameBuffer.empty() && m_registerReadBuffer.size() < m_config.width) {
-        Instruction inst = m_renameBuffer.front();
+    STATS_HOOK(size_t moved = 0;)
+    while (!m_renameBuffer.empty() && m_registerReadBuffer.size() < width()) {
+        STATS_HOOK(moved++;)
+        int handle = m_renameBuffer.front();
+        InstructionState& inst = m_arena.state(handle);
 
         // Allocate ROB entry
         m_reorderBuffer[m_robTail].valid = true;
         m_reorderBuffer[m_robTail].ready = false;
-        m_reorderBuffer[m_robTail].instruction = inst;
+        m_reorderBuffer[m_robTail].handle = handle;
+        m_robOccupancy++;
 
-        // Rename source registers
+        // Rename source registers and register with the producer's wakeup list
         if (inst.src1Reg != -1 && m_renameTable[inst.src1Reg].valid) {
             inst.src1Rename = m_renameTable[inst.src1Reg].robTag;
+            m_wakeupLists[inst.src1Rename].push_back(handle * 2);
         }
 
         if (inst.src2Reg != -1 && m_renameTable[inst.src2Reg].valid) {
             inst.src2Rename = m_renameTable[inst.src2Reg].robTag;
+            m_wakeupLists[inst.src2Rename].push_back(handle * 2 + 1);
         }
 
         m_reorderBuffer[m_robTail].destArchReg = inst.destReg;
@@ -159,30 +328,39 @@ void OutOfOrderProcessor::renameStage() {
         inst.destRename = m_robTail;
 
         // Set rename timing and advance
-        inst.renameDuration = m_cycleCount - inst.renameCycle + 1;
-        m_registerReadBuffer.push_back(inst);
+        Instruction& record = m_arena.record(handle);
+        record.destRename = m_robTail;
+        record.renameDuration = m_cycleCount - record.renameCycle + 1;
+        record.regReadCycle = m_cycleCount + 1;
+        m_registerReadBuffer.push_back(handle);
         m_renameBuffer.pop_front();
+        m_progress = true;
 
         // Advance ROB tail
-        m_robTail = (m_robTail + 1) % m_config.robSize;
+        m_robTail = nextRobSlot(m_robTail);
     }
-}
 
-// Register Read stage: Prepare instructions for dispatch
-void OutOfOrderProcessor::registerReadStage() {
-    // Mark register read cycle for new instructions
-    for (auto& inst : m_registerReadBuffer) {
-        if (inst.regReadCycle == -1) {
-            inst.regReadCycle = m_cycleCount;
+    STATS_HOOK(
+        if (moved < width()) {
+            m_stats.stageStall[STAGE_RENAME] = m_renameBuffer.empty() ? STALL_INPUT_EMPTY : STALL_OUTPUT_FULL;
         }
-    }
+    )
+}
 
+// Register Read stage: Prepare instructions for dispatch
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::registerReadStage() {
     // Check if dispatch buffer is full
-    if (m_dispatchBuffer.size() == m_config.width)
+    if (m_dispatchBuffer.size() == width()) {
+        STATS_HOOK(m_stats.stageStall[STAGE_REGREAD] = STALL_OUTPUT_FULL;)
         return;
+    }
 
-    while (!m_registerReadBuffer.empty() && m_dispatchBuffer.size() < m_config.width) {
-        Instruction inst = m_registerReadBuffer.front();
+    STATS_HOOK(size_t moved = 0;)
+    while (!m_registerReadBuffer.empty() && m_dispatchBuffer.size() < width()) {
+        STATS_HOOK(moved++;)
+        int handle = m_registerReadBuffer.front();
+        InstructionState& inst = m_arena.state(handle);
 
         // Check if source registers are ready
         if (inst.src1Rename != -1 && m_reorderBuffer[inst.src1Rename].ready) {
@@ -194,260 +372,327 @@ void OutOfOrderProcessor::registerReadStage() {
         }
 
         // Set timing and advance
-        inst.regReadDuration = m_cycleCount - inst.regReadCycle + 1;
-        m_dispatchBuffer.push_back(inst);
+        Instruction& record = m_arena.record(handle);
+        record.regReadDuration = m_cycleCount - record.regReadCycle + 1;
+        record.dispatchCycle = m_cycleCount + 1;
+        m_dispatchBuffer.push_back(handle);
         m_registerReadBuffer.pop_front();
+        m_progress = true;
     }
-}
 
-// Dispatch stage: Move instructions to Issue Queue
-void OutOfOrderProcessor::dispatchStage() {
-    // Mark dispatch cycle for new instructions
-    for (auto& inst : m_dispatchBuffer) {
-        if (inst.dispatchCycle == -1) {
-            inst.dispatchCycle = m_cycleCount;
+    STATS_HOOK(
+        if (moved < width()) {
+            m_stats.stageStall[STAGE_REGREAD] = m_registerReadBuffer.empty() ? STALL_INPUT_EMPTY : STALL_OUTPUT_FULL;
         }
-    }
+    )
+}
 
+// Dispatch stage: Move instructions to Issue Queue
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::dispatchStage() {
     // Check if issue queue is full
     if (isIssueQueueFull()) {
+        STATS_HOOK(m_stats.stageStall[STAGE_DISPATCH] = STALL_IQ_FULL;)
         return;
     }
 
-    while (!m_dispatchBuffer.empty()) {
-        // Find an empty slot in the issue queue
-        for (size_t i = 0; i < m_config.iqSize; i++) {
-            if (m_issueQueue[i].valid) continue;
+    STATS_HOOK(size_t moved = 0;)
+    while (!m_dispatchBuffer.empty() && !m_iqFreeSlots.empty()) {
+        STATS_HOOK(moved++;)
+        // Take the lowest-numbered empty slot in the issue queue
+        int i = m_iqFreeSlots.top();
+        m_iqFreeSlots.pop();
 
-            // Update source rename dependencies
-            if (m_dispatchBuffer.front().src1Rename != -1 && 
-                m_reorderBuffer[m_dispatchBuffer.front().src1Rename].ready) {
-                m_dispatchBuffer.front().src1Rename = -1;
-            }
-            if (m_dispatchBuffer.front().src2Rename != -1 && 
-                m_reorderBuffer[m_dispatchBuffer.front().src2Rename].ready) {
-                m_dispatchBuffer.front().src2Rename = -1;
-            }
+        int handle = m_dispatchBuffer.front();
+        InstructionState& inst = m_arena.state(handle);
 
-            // Move to Issue Stage
-            m_dispatchBuffer.front().dispatchDuration = 
-                m_cycleCount - m_dispatchBuffer.front().dispatchCycle + 1;
-            m_issueQueue[i].valid = true;
-            m_issueQueue[i].instruction = m_dispatchBuffer.front();
-            
-            break;
+        // Update source rename dependencies
+        if (inst.src1Rename != -1 && m_reorderBuffer[inst.src1Rename].ready) {
+            inst.src1Rename = -1;
+        }
+        if (inst.src2Rename != -1 && m_reorderBuffer[inst.src2Rename].ready) {
+            inst.src2Rename = -1;
+        }
+
+        // Move to Issue Stage
+        Instruction& record = m_arena.record(handle);
+        record.dispatchDuration = m_cycleCount - record.dispatchCycle + 1;
+        m_issueQueue[i].valid = true;
+        m_issueQueue[i].handle = handle;
+        inst.iqSlot = i;
+        m_newIssueQueueSlots.push_back(i);
+        m_iqOccupancy++;
+        m_progress = true;
+
+        // Instructions with no outstanding sources are immediately eligible for select
+        if (isInstructionReady(i)) {
+            m_readyBits.set(inst.destRename);
         }
         
         m_dispatchBuffer.pop_front();
     }
+
+    STATS_HOOK(
+        if (moved < width()) {
+            m_stats.stageStall[STAGE_DISPATCH] = m_dispatchBuffer.empty() ? STALL_INPUT_EMPTY : STALL_IQ_FULL;
+        }
+    )
 }
 
 // Issue stage: Select and prepare instructions for execution
-void OutOfOrderProcessor::issueStage() {
-    // Prevent issuing if execution list is full
-    if (m_executionList.size() == m_config.width * 5) {
-        return;
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::issueStage() {
+    // Pipelined units take a new operation every cycle; unpipelined ones stay busy
+    bool saturated = true;
+    for (size_t unitClass = 0; unitClass < m_unitClassCount; unitClass++) {
+        m_unitsBusy[unitClass] *= m_unitReleased[unitClass];
+        saturated &= m_unitsBusy[unitClass] == m_unitLimit[unitClass];
     }
 
-    // Mark issue cycle for new instructions
-    for (auto& entry : m_issueQueue) {
-        if (entry.valid && entry.instruction.issueCycle == -1) {
-            entry.instruction.issueCycle = m_cycleCount;
-        }
+    // Prevent issuing if every function unit is busy
+    if (saturated) {
+        STATS_HOOK(m_stats.stageStall[STAGE_ISSUE] = STALL_EXEC_FULL; m_stats.waiting = m_iqOccupancy;)
+        return;
     }
 
-    // Issue up to width instructions
-    for (size_t i = 0; i < m_config.width; i++) {
-        // Find oldest ready instruction
-        int oldestCycle = INT_MAX;
-        int oldestIdx = -1;
-
-        for (size_t j = 0; j < m_config.iqSize; j++) {
-            // Skip invalid or dependent instructions
-            if (!m_issueQueue[j].valid) continue;
-            if (m_issueQueue[j].instruction.src1Rename != -1) continue;
-            if (m_issueQueue[j].instruction.src2Rename != -1) continue;
-            
-            // Select oldest ready instruction
-            if (isInstructionReady(j) &&
-                m_issueQueue[j].instruction.fetchCycle < oldestCycle) {
-                oldestCycle = m_issueQueue[j].instruction.fetchCycle;
-                oldestIdx = j;
+    // Mark issue cycle for instructions that entered the issue queue since the last issue
+    for (int slot : m_newIssueQueueSlots) {
+        if (m_issueQueue[slot].valid) {
+            Instruction& record = m_arena.record(m_issueQueue[slot].handle);
+            if (record.issueCycle == -1) {
+                record.issueCycle = m_cycleCount;
+                m_progress = true;
             }
         }
-
-        if (oldestIdx == -1) {
-            return;  // No ready instructions found
+    }
+    m_newIssueQueueSlots.clear();
+
+    // Gather ready instructions oldest first. The ready bits are indexed by ROB slot, so scanning
+    // from the ROB head visits them in program order; stop once width candidates with a free unit
+    // are found and the next one belongs to a younger fetch group. Select reorders only within
+    // fetch groups, so it finds its width instructions among these.
+    m_issueCandidates.clear();
+    std::copy(m_unitsBusy, m_unitsBusy + m_unitClassCount, m_unitsReserved);
+    size_t filled = 0;     // Candidates that found a free unit
+    int lastGroup = -1;    // Fetch cycle of the candidate that filled the last slot
+    long robSlot = m_readyBits.findNext(m_robHead, robSize());
+    bool wrapped = false;
+    while (true) {
+        if (robSlot == -1) {
+            if (wrapped) break;
+            wrapped = true;
+            robSlot = m_readyBits.findNext(0, m_robHead);
+            continue;
         }
 
-        // Determine execution latency based on operation type
-        int execLatency = (m_issueQueue[oldestIdx].instruction.opType == 0) ? 1 : 
-                          (m_issueQueue[oldestIdx].instruction.opType == 1) ? 2 : 5;
+        const InstructionState& inst = m_arena.state(m_reorderBuffer[robSlot].handle);
+        if (filled >= width() && inst.fetchCycle != lastGroup) {
+            break;
+        }
+        m_issueCandidates.push_back(std::make_pair(inst.fetchCycle, inst.iqSlot));
+        if (m_unitsReserved[inst.unitClass] < m_unitLimit[inst.unitClass]) {
+            m_unitsReserved[inst.unitClass]++;
+            if (++filled == width()) {
+                lastGroup = inst.fetchCycle;
+            }
+        }
 
-        // Move to execution list
-        m_issueQueue[oldestIdx].instruction.issueDuration = 
-            m_cycleCount - m_issueQueue[oldestIdx].instruction.issueCycle + 1;
-        ExecutionEntry ex_inst = {m_issueQueue[oldestIdx].instruction, execLatency};
-        m_executionList.push_back(ex_inst);
+        robSlot = m_readyBits.findNext(robSlot + 1, wrapped ? m_robHead : robSize());
+    }
 
-        // Clear issue queue entry
+    // Oldest means earliest fetch cycle, ties going to the lowest issue queue slot
+    std::sort(m_issueCandidates.begin(), m_issueCandidates.end());
+
+    // Issue up to width instructions, passing over those whose function units are all busy
+    STATS_HOOK(bool wasEmpty = isIssueQueueEmpty(); bool unitsFull = false;)
+    size_t issueCount = 0;
+    for (size_t i = 0; i < m_issueCandidates.size() && issueCount < width(); i++) {
+        int oldestIdx = m_issueCandidates[i].second;
+        int handle = m_issueQueue[oldestIdx].handle;
+        InstructionState& inst = m_arena.state(handle);
+        if (m_unitsBusy[inst.unitClass] == m_unitLimit[inst.unitClass]) {
+            STATS_HOOK(unitsFull = true;)
+            continue;
+        }
+        m_unitsBusy[inst.unitClass]++;
+        issueCount++;
+
+        // Schedule completion; execution begins in the next cycle
+        Instruction& record = m_arena.record(handle);
+        record.issueDuration = m_cycleCount - record.issueCycle + 1;
+        record.executeCycle = m_cycleCount + 1;
+        ExecutionEntry ex_inst = {handle, inst.latency};
+        m_completionWheel[(m_cycleCount + inst.latency) & m_wheelMask].push_back(ex_inst);
+        m_executingCount++;
+
+        // Clear issue queue entry and return its slot to the free list
         m_issueQueue[oldestIdx].valid = false;
+        inst.iqSlot = -1;
+        m_readyBits.clear(inst.destRename);
+        m_iqFreeSlots.push(oldestIdx);
+        m_iqOccupancy--;
+        m_progress = true;
     }
+
+    STATS_HOOK(
+        if (issueCount < width()) {
+            m_stats.stageStall[STAGE_ISSUE] = wasEmpty ? STALL_INPUT_EMPTY : unitsFull ? STALL_EXEC_FULL : STALL_NOT_READY;
+        }
+        m_stats.issued = issueCount;
+        m_stats.waiting = m_iqOccupancy;
+    )
 }
 
 // Execute stage: Process instructions in execution
-void OutOfOrderProcessor::executeStage() {
-    // Check if execution list has any instructions
-    if (m_executionList.empty()) {
-        return;
-    }
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::executeStage() {
+    // Operations finishing this cycle join any held back by writeback backpressure
+    std::vector<ExecutionEntry>& finishing = m_completionWheel[m_cycleCount & m_wheelMask];
+    m_completedExecutions.insert(m_completedExecutions.end(), finishing.begin(), finishing.end());
+    finishing.clear();
 
-    // Set execute cycle and decrease remaining cycles
-    for (auto& execEntry : m_executionList) {
-        if (execEntry.instruction.executeCycle == -1) {
-            execEntry.instruction.executeCycle = m_cycleCount;
+    // Process completed instructions
+    while (!m_completedExecutions.empty()) {
+        // A full writeback buffer stalls the remaining completions in their units until next cycle
+        if (m_writebackBuffer.size() == width() * WRITEBACK_LATCH_FACTOR) {
+            STATS_HOOK(m_stats.stageStall[STAGE_EXECUTE] = STALL_WRITEBACK_FULL;)
+            return;
         }
-        execEntry.remainingCycles--;
+
+        int handle = m_completedExecutions.front().handle;
+        const InstructionState& inst = m_arena.state(handle);
+
+        // Wake up dependent instructions in the issue queue and earlier stages
+        wakeupDependents(inst.destRename);
+
+        // Move completed instruction to writeback; the writeback stage sees it next cycle
+        Instruction& record = m_arena.record(handle);
+        record.executeDuration = m_cycleCount - record.executeCycle + 1;
+        record.writebackCycle = m_cycleCount + 1;
+        record.valid = true;
+        m_writebackBuffer.push_back(handle);
+
+        m_completedExecutions.pop_front();
+        m_executingCount--;
+        m_unitsBusy[inst.unitClass] -= m_unitReleased[inst.unitClass];
+        m_progress = true;
     }
+}
 
-    // Process completed instructions
-    while (isExecutionNeeded()) {
-        for (size_t i = 0; i < m_executionList.size(); i++) {
-            if (m_executionList[i].remainingCycles == 0) {
-                // Wake up dependent instructions in issue queue
-                for (size_t j = 0; j < m_config.iqSize; j++) {
-                    if ((m_issueQueue[j].instruction.src1Rename == m_executionList[i].instruction.destRename) && 
-                        m_issueQueue[j].instruction.src1Rename != -1) {
-                        m_issueQueue[j].instruction.src1Rename = -1;
-                    }
-                    if ((m_issueQueue[j].instruction.src2Rename == m_executionList[i].instruction.destRename) && 
-                        m_issueQueue[j].instruction.src2Rename != -1) {
-                        m_issueQueue[j].instruction.src2Rename = -1;
-                    }
-                }
-
-                // Wake up dependent instructions in other stages
-                for (auto& inst : m_dispatchBuffer) {
-                    if (inst.src1Rename == m_executionList[i].instruction.destRename) {
-                        inst.src1Rename = -1;
-                    }
-                    if (inst.src2Rename == m_executionList[i].instruction.destRename) {
-                        inst.src2Rename = -1;
-                    }
-                }
-
-                for (auto& inst : m_registerReadBuffer) {
-                    if (inst.src1Rename == m_executionList[i].instruction.destRename) {
-                        inst.src1Rename = -1;
-                    }
-                    if (inst.src2Rename == m_executionList[i].instruction.destRename) {
-                        inst.src2Rename = -1;
-                    }
-                }
-
-                // Check if writeback buffer is full
-                if (m_writebackBuffer.size() == m_config.width * 5) {
-                    return;
-                }
-
-                // Move completed instruction to writeback
-                m_executionList[i].instruction.executeDuration = 
-                    m_cycleCount - m_executionList[i].instruction.executeCycle + 1;
-                m_executionList[i].instruction.valid = true;
-                m_writebackBuffer.push_back(m_executionList[i].instruction);
-
-                m_executionList.erase(m_executionList.begin() + i);
+// Clear source tags waiting on a completed producer, touching only registered consumers.
+// A tag wakes every instruction still holding it, as a broadcast on the tag value would;
+// consumers that already issued (or whose handle was recycled) no longer hold it.
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::wakeupDependents(int robTag) {
+    for (int consumer : m_wakeupLists[robTag]) {
+        InstructionState& inst = m_arena.state(consumer / 2);
+
+        int& srcRename = (consumer % 2 == 0) ? inst.src1Rename : inst.src2Rename;
+        if (srcRename == robTag) {
+            srcRename = -1;
+
+            // An issue queue entry with both sources available becomes ready for select
+            if (inst.iqSlot != -1 && isInstructionReady(inst.iqSlot)) {
+                m_readyBits.set(inst.destRename);
             }
         }
     }
+    m_wakeupLists[robTag].clear();
 }
 
 // Writeback stage: Complete instruction execution and mark ROB entries as ready
-void OutOfOrderProcessor::writebackStage() {
-    // Set writeback cycle for new instructions in the writeback buffer
-    for (auto& inst : m_writebackBuffer) {
-        if (m_writebackBuffer.size() && inst.writebackCycle == -1) {
-            inst.writebackCycle = m_cycleCount;
-        }
-    }
-    
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::writebackStage() {
     // Process instructions in the writeback buffer
     while (!m_writebackBuffer.empty()) {
-        // Find corresponding ROB entry for the instruction
-        for (size_t i = 0; i < m_config.robSize; i++) {
-            // Check if the ROB entry is valid and matches the instruction sequence number
-            if (m_reorderBuffer[i].valid && 
-                m_reorderBuffer[i].instruction.sequenceNum == m_writebackBuffer.front().sequenceNum) {
-                
-                // Mark the ROB entry as ready for retirement
-                m_reorderBuffer[i].ready = true;
+        // The ROB slot allocated at rename travels with the instruction as destRename
+        int handle = m_writebackBuffer.front();
+        ReorderBufferEntry& entry = m_reorderBuffer[m_arena.state(handle).destRename];
+        assert(entry.valid && entry.handle == handle);
 
-                // Calculate and set writeback duration
-                m_writebackBuffer.front().writebackDuration = 
-                    m_cycleCount - m_writebackBuffer.front().writebackCycle + 1;
-                
-                // Update the ROB entry with the instruction details
-                m_reorderBuffer[i].instruction = m_writebackBuffer.front();
-                
-                // Remove the processed instruction from the writeback buffer
-                m_writebackBuffer.pop_front();
+        // Mark the ROB entry as ready for retirement
+        entry.ready = true;
 
-                // Exit inner loop if writeback buffer is empty
-                if (m_writebackBuffer.empty()) {
-                    break;
-                }
-            }
-        }
+        // Calculate and set writeback duration
+        Instruction& record = m_arena.record(handle);
+        record.writebackDuration = m_cycleCount - record.writebackCycle + 1;
+
+        // The retire stage first sees the entry as ready in the next cycle
+        record.retireCycle = m_cycleCount + 1;
+
+        // Remove the processed instruction from the writeback buffer
+        m_writebackBuffer.pop_front();
+        m_progress = true;
     }
 }
 
 // Retire stage: Commit completed instructions from the Reorder Buffer
-void OutOfOrderProcessor::retireStage() {
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::retireStage() {
     // Skip if Reorder Buffer is empty
     if (isReorderBufferEmpty()) {
+        STATS_HOOK(m_stats.stageStall[STAGE_RETIRE] = STALL_INPUT_EMPTY; m_stats.retireLoss = RETIRE_ROB_EMPTY;)
         return;
     }
 
-    // Set retire cycle for ready instructions in the Reorder Buffer
-    for (size_t i = 0; i < m_reorderBuffer.size(); i++) {
-        if (m_reorderBuffer[i].ready && m_reorderBuffer[i].instruction.retireCycle == -1) {
-            m_reorderBuffer[i].instruction.retireCycle = m_cycleCount;
-        }
-    }
-
     // Retire up to processor width number of instructions
-    for (size_t i = 0; i < m_config.width; i++) {
+    for (size_t i = 0; i < width(); i++) {
         // Check if the ROB head entry is valid and ready to retire
         if (m_reorderBuffer[m_robHead].valid && m_reorderBuffer[m_robHead].ready) {
+            int handle = m_reorderBuffer[m_robHead].handle;
+            const InstructionState& inst = m_arena.state(handle);
+
             // Calculate retire duration
-            m_reorderBuffer[m_robHead].instruction.retireDuration = 
-                m_cycleCount - m_reorderBuffer[m_robHead].instruction.retireCycle + 1;
+            Instruction& record = m_arena.record(handle);
+            record.retireDuration = m_cycleCount - record.retireCycle + 1;
 
-            // Optionally print instruction details (can be commented out if not needed)
+            // Hand the timing record to the retire log (per-instruction output), if any
             // Uncomment the following line to print specific instruction details
-            //if (m_reorderBuffer[m_robHead].instruction.sequenceNum == 9618)
-            printInstructionDetails(m_reorderBuffer[m_robHead].instruction);
+            //if (record.sequenceNum == 9618) printInstructionDetails(record);
+            if (m_options.retireSink) {
+                m_options.retireSink->retire(record);
+            }
 
             // Clear rename table mapping for the retired instruction's destination register
-            if (m_reorderBuffer[m_robHead].instruction.destReg != -1 && 
-                m_reorderBuffer[m_robHead].instruction.destRename == 
-                    m_renameTable[m_reorderBuffer[m_robHead].instruction.destReg].robTag) {
+            if (inst.destReg != -1 && 
+                inst.destRename == m_renameTable[inst.destReg].robTag) {
                 
-                m_renameTable[m_reorderBuffer[m_robHead].instruction.destReg].valid = false;
-                m_renameTable[m_reorderBuffer[m_robHead].instruction.destReg].robTag = -1;
+                m_renameTable[inst.destReg].valid = false;
+                m_renameTable[inst.destReg].robTag = -1;
             }
 
-            // Clear the Reorder Buffer entry at the head
+            // Clear the Reorder Buffer entry at the head and release the instruction
             m_reorderBuffer[m_robHead].valid = false;
+            m_robOccupancy--;
+            m_retiredCount++;
+            m_arena.release(handle);
+            STATS_HOOK(m_stats.retired++;)
 
             // Advance the Reorder Buffer head pointer
-            m_robHead = (m_robHead + 1) % m_config.robSize;
+            m_robHead = nextRobSlot(m_robHead);
+            m_progress = true;
         }
     }
+
+    // Attribute the unused retire slots to the state of the instruction blocking the head
+    STATS_HOOK(
+        if (m_stats.retired < width()) {
+            if (isReorderBufferEmpty()) {
+                m_stats.stageStall[STAGE_RETIRE] = STALL_INPUT_EMPTY;
+                m_stats.retireLoss = RETIRE_ROB_EMPTY;
+            }
+            else {
+                const Instruction& head = m_arena.record(m_reorderBuffer[m_robHead].handle);
+                m_stats.stageStall[STAGE_RETIRE] = STALL_HEAD_NOT_DONE;
+                m_stats.retireLoss = head.executeCycle == -1 ? RETIRE_HEAD_WAITING : RETIRE_HEAD_EXECUTING;
+            }
+        }
+    )
 }
 
 // Print detailed information about a specific instruction
-void OutOfOrderProcessor::printInstructionDetails(const Instruction& inst) const {
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::printInstructionDetails(const Instruction& inst) const {
     std::cout << inst.sequenceNum << " "
               << "fu{" << inst.opType << "} "
               << "src{" << inst.src1Reg << "," << inst.src2Reg << "} "
@@ -465,7 +710,8 @@ void OutOfOrderProcessor::printInstructionDetails(const Instruction& inst) const
 }
 
 // Print overall simulation results and performance metrics
-void OutOfOrderProcessor::printSimulationResults() const {
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::printSimulationResults() const {
     // Calculate Instructions Per Cycle (IPC)
     float ipc = static_cast<float>(m_instructionCount) / m_cycleCount;
     
@@ -476,8 +722,19 @@ void OutOfOrderProcessor::printSimulationResults() const {
               << std::fixed << std::setprecision(2) << ipc << std::endl;
 }
 
+// Print the stall attribution and occupancy report, or a note when statistics are not compiled in
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::printPipelineStats() const {
+#ifdef PIPELINE_STATS
+    m_stats.print();
+#else
+    std::cout << "# Pipeline statistics are not compiled in (rebuild with make STATS=1)" << std::endl;
+#endif
+}
+
 // Create and initialize a new instruction with default values
-Instruction OutOfOrderProcessor::createInstruction(
+template <size_t Width, size_t RobSize, size_t IqSize>
+Instruction OutOfOrderProcessor<Width, RobSize, IqSize>::createInstruction(
     uint64_t pc, 
     int opType, 
     int destReg, 
@@ -517,38 +774,25 @@ Instruction OutOfOrderProcessor::createInstruction(
 }
 
 // Check if the Reorder Buffer is full
-bool OutOfOrderProcessor::isReorderBufferFull() const {
-    // Count empty slots in the Reorder Buffer
-    int emptySlots = 0;
-    for (const auto& entry : m_reorderBuffer) {
-        if (!entry.valid) {
-            emptySlots++;
-        }
-    }
-    
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::isReorderBufferFull() const {
     // Consider ROB full if fewer empty slots than processor width
-    return emptySlots < m_config.width;
+    return robSize() - m_robOccupancy < width();
 }
 
 // Check if the Issue Queue is full
-bool OutOfOrderProcessor::isIssueQueueFull() const {
-    // Count empty slots in the Issue Queue
-    int emptySlots = 0;
-    for (const auto& entry : m_issueQueue) {
-        if (!entry.valid) {
-            emptySlots++;
-        }
-    }
-    
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::isIssueQueueFull() const {
     // Consider IQ full if fewer empty slots than processor width
-    return emptySlots < m_config.width;
+    return iqSize() - m_iqOccupancy < width();
 }
 
 // Check if an instruction in the Issue Queue is ready for execution
-bool OutOfOrderProcessor::isInstructionReady(size_t j) const {
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::isInstructionReady(size_t j) const {
     // Check if any source register still has an outstanding dependency
-    if (m_issueQueue[j].instruction.src1Rename != -1 || 
-        m_issueQueue[j].instruction.src2Rename != -1) {
+    const InstructionState& inst = m_arena.state(m_issueQueue[j].handle);
+    if (inst.src1Rename != -1 || inst.src2Rename != -1) {
         return false;
     }
 
@@ -556,61 +800,132 @@ bool OutOfOrderProcessor::isInstructionReady(size_t j) const {
     return true;
 }
 
-// Check if any instruction in the execution list needs processing
-bool OutOfOrderProcessor::isExecutionNeeded() const {
-    // Iterate through execution list
-    for (const auto& execEntry : m_executionList) {
-        // If any instruction's execution time has reached zero
-        if (execEntry.remainingCycles == 0) {
-            return true;
-        }
-    }
-    return false;
-}
-
 // Advance the simulation cycle and determine if simulation should continue
-bool OutOfOrderProcessor::advanceCycle() {
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::advanceCycle() {
     // Increment cycle count
     m_cycleCount++;
 
     // Check if there are still instructions in any pipeline stage
-    bool hasInstructions =
+    return hasInstructionsInFlight();
+}
+
+// Check if there are still instructions in any pipeline stage
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::hasInstructionsInFlight() const {
+    return
         m_decodeBuffer.size() ||
         m_renameBuffer.size() ||
         m_registerReadBuffer.size() ||
         m_dispatchBuffer.size() ||
         !isIssueQueueEmpty() ||
-        m_executionList.size() ||
+        m_executingCount ||
         m_writebackBuffer.size() ||
         !isReorderBufferEmpty();
-
-    return hasInstructions;
 }
 
-// Check if the Reorder Buffer is empty
-bool OutOfOrderProcessor::isReorderBufferEmpty() const {
-    for (const auto& entry : m_reorderBuffer) {
-        if (entry.valid) {
-            return false;
+// Jump over cycles in which no stage can make progress (when enabled), and detect deadlock. The pipeline state only depends on the
+// cycle count through timestamps taken when something changes, so after a cycle without any
+// change, every following cycle is identical until the next function unit completes.
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::skipIdleCycles(uint64_t cycleLimit) {
+    // Completions held back by writeback backpressure retry every cycle
+    if (!m_completedExecutions.empty()) {
+        return;
+    }
+
+    for (uint64_t cycle = m_cycleCount + 1; cycle < m_cycleCount + m_completionWheel.size(); cycle++) {
+        if (!m_completionWheel[cycle & m_wheelMask].empty()) {
+            // advanceCycle() moves on to the completion cycle itself, or to the cycle limit
+            if (m_options.skipIdleCycles) {
+                m_cycleCount = std::max(m_cycleCount, std::min(cycle, cycleLimit) - 1);
+            }
+            return;
         }
     }
-    return true;
+
+    // No pending event can ever unblock the remaining instructions
+    if (hasInstructionsInFlight()) {
+        throw std::runtime_error("pipeline deadlock: no stage can make progress "
+                                 "(IQ_SIZE and ROB_SIZE must be at least WIDTH)");
+    }
+}
+
+#ifdef PIPELINE_STATS
+// Fold the observations of the cycle just evaluated into the statistics
+template <size_t Width, size_t RobSize, size_t IqSize>
+void OutOfOrderProcessor<Width, RobSize, IqSize>::recordCycleStats(uint64_t weight) {
+    bool drained = m_simulationComplete && m_decodeBuffer.empty() && m_renameBuffer.empty() &&
+                   m_registerReadBuffer.empty() && m_dispatchBuffer.empty();
+    m_stats.endCycle(width(), weight, drained);
+
+    m_stats.recordOccupancy(OCC_ROB, m_robOccupancy, weight);
+    m_stats.recordOccupancy(OCC_IQ, m_iqOccupancy, weight);
+    m_stats.recordOccupancy(OCC_DECODE, m_decodeBuffer.size(), weight);
+    m_stats.recordOccupancy(OCC_RENAME, m_renameBuffer.size(), weight);
+    m_stats.recordOccupancy(OCC_REGREAD, m_registerReadBuffer.size(), weight);
+    m_stats.recordOccupancy(OCC_DISPATCH, m_dispatchBuffer.size(), weight);
+    m_stats.recordOccupancy(OCC_EXECUTING, m_executingCount, weight);
+    m_stats.recordOccupancy(OCC_WRITEBACK, m_writebackBuffer.size(), weight);
+}
+#endif
+
+// Check if the Reorder Buffer is empty
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::isReorderBufferEmpty() const {
+    return m_robOccupancy == 0;
 }
 
 // Check if the Issue Queue is empty
-bool OutOfOrderProcessor::isIssueQueueEmpty() const {
-    for (const auto& entry : m_issueQueue) {
-        if (entry.valid) {
-            return false;
-        }
-    }
-    return true;
+template <size_t Width, size_t RobSize, size_t IqSize>
+bool OutOfOrderProcessor<Width, RobSize, IqSize>::isIssueQueueEmpty() const {
+    return m_iqOccupancy == 0;
+}
+
+// Count valid entries in the Reorder Buffer
+template <size_t Width, size_t RobSize, size_t IqSize>
+int OutOfOrderProcessor<Width, RobSize, IqSize>::countROBEntries() const {
+    return m_robOccupancy;
+}
+
+// Count valid entries in the Issue Queue
+template <size_t Width, size_t RobSize, size_t IqSize>
+int OutOfOrderProcessor<Width, RobSize, IqSize>::countIQEntries() const {
+    return m_iqOccupancy;
 }
 
 // Destructor to clean up resources
-OutOfOrderProcessor::~OutOfOrderProcessor() {
-    // Close trace file if it's open
-    if (m_traceFile) {
-        fclose(m_traceFile);
+template <size_t Width, size_t RobSize, size_t IqSize>
+OutOfOrderProcessor<Width, RobSize, IqSize>::~OutOfOrderProcessor() {
+    // The caller owns the instruction source and its trace file or mapping
+}
+
+// Run-time sized engine and the fixed-geometry specializations
+#define INSTANTIATE_ENGINE(WIDTH, ROB_SIZE, IQ_SIZE) template class OutOfOrderProcessor<WIDTH, ROB_SIZE, IQ_SIZE>;
+INSTANTIATE_ENGINE(0, 0, 0)
+SPECIALIZED_CONFIGURATIONS(INSTANTIATE_ENGINE)
+
+// Check whether a configuration has a fixed-geometry specialization
+bool hasSpecializedEngine(const ProcessorParameters& config) {
+#define MATCH_ENGINE(WIDTH, ROB_SIZE, IQ_SIZE) \
+    if (config.width == WIDTH && config.robSize == ROB_SIZE && config.iqSize == IQ_SIZE) return true;
+    SPECIALIZED_CONFIGURATIONS(MATCH_ENGINE)
+#undef MATCH_ENGINE
+    return false;
+}
+
+// Create the engine for a configuration, specialized when possible
+std::unique_ptr<SimulationEngine> makeProcessor(
+    const ProcessorParameters& config,
+    InstructionSource& source,
+    const SimulationOptions& options
+) {
+    if (options.specializeGeometry) {
+#define MAKE_ENGINE(WIDTH, ROB_SIZE, IQ_SIZE) \
+        if (config.width == WIDTH && config.robSize == ROB_SIZE && config.iqSize == IQ_SIZE) \
+            return std::unique_ptr<SimulationEngine>(new OutOfOrderProcessor<WIDTH, ROB_SIZE, IQ_SIZE>(config, source, options));
+        SPECIALIZED_CONFIGURATIONS(MAKE_ENGINE)
+#undef MAKE_ENGINE
     }
+    return std::unique_ptr<SimulationEngine>(new OutOfOrderProcessor<>(config, source, options));
 }
\ No newline at end of file
@@ -4,44 +4,153 @@
 #include <iostream>
 #include <vector>
 #include <deque>
+#include <functional>
 #include <iomanip>
+#include <queue>
+#include <memory>
+#include <string>
 #include "processor_config.h"
+#include "bit_vector.h"
+#include "fixed_storage.h"
+#include "function_units.h"
+#include "instruction_arena.h"
+#include "instruction_source.h"
+#include "pipeline_stats.h"
 
 // Number of Architectural Registers
 #define ARF_SIZE 67
 
-// OutOfOrderProcessor: Simulates a superscalar out-of-order processor with dynamic scheduling
-class OutOfOrderProcessor {
+// Writeback latch entries per unit of width
+#define WRITEBACK_LATCH_FACTOR 5
+
+// Timing model version, part of every result cache key; increment whenever a change to the model
+// alters simulated cycle counts, so stale cached results stop matching
+#define SIMULATOR_VERSION 1
+
+// Fixed-geometry engines compiled into the simulator, as X(WIDTH, ROB_SIZE, IQ_SIZE).
+// makeProcessor() picks one of these for a matching configuration; any other configuration runs
+// on the run-time sized engine.
+#define SPECIALIZED_CONFIGURATIONS(X) \
+    X(1, 16, 8)      X(1, 32, 16)                                                   \
+    X(2, 32, 16)     X(2, 64, 32)                                                   \
+    X(4, 64, 32)     X(4, 128, 32)    X(4, 128, 64)    X(4, 256, 64)                \
+    X(8, 128, 64)    X(8, 256, 64)    X(8, 256, 128)   X(8, 512, 128)  X(8, 512, 256) \
+    X(16, 256, 128)  X(16, 512, 128)  X(16, 512, 256)  X(16, 1024, 256)              \
+    X(16, 2048, 512) X(16, 2048, 1024) X(16, 2048, 2048)
+
+// SimulationEngine: Interface shared by the run-time sized engine and its fixed-geometry
+// specializations, so drivers can run whichever makeProcessor() selected
+class SimulationEngine {
+public:
+    virtual ~SimulationEngine() {}
+
+    // Main Simulation Methods
+    virtual void simulate() = 0;                           // Run complete simulation
+    virtual bool stepCycle() = 0;                          // Evaluate one cycle (or idle stretch); false once the pipeline drained
+    virtual bool runUntilRetired(uint64_t count) = 0;      // Simulate until count instructions retired; false if the trace ran out first
+    virtual bool runUntilCycle(uint64_t cycle) = 0;        // Simulate until the cycle count reaches cycle; false if the pipeline drained first
+    virtual bool runCycles(uint64_t count) = 0;            // Simulate count more cycles; false if the pipeline drained first
+    virtual void printSimulationResults() const = 0;       // Display simulation statistics
+    virtual void printPipelineStats() const = 0;           // Display stall attribution report (make STATS=1)
+
+    // Checkpointing (checkpoint.cpp)
+    virtual void saveCheckpoint(const std::string& path) const = 0;  // Save all pipeline state and the trace offset
+    virtual void restoreCheckpoint(const std::string& path) = 0;     // Resume a saved run; the source must be at the start of the trace
+
+    // Simulation Results
+    virtual uint64_t instructionCount() const = 0;  // Instructions fetched so far
+    virtual uint64_t cycleCount() const = 0;        // Cycles simulated so far
+    virtual uint64_t retiredCount() const = 0;      // Instructions retired so far
+    virtual bool isFinished() const = 0;            // Trace consumed and pipeline drained
+};
+
+// OutOfOrderProcessor: Simulates a superscalar out-of-order processor with dynamic scheduling.
+// Width, RobSize and IqSize fix the geometry at compile time (inline storage, constant loop
+// bounds, masked ROB wrap); 0 takes that parameter from the run-time configuration.
+template <size_t Width = 0, size_t RobSize = 0, size_t IqSize = 0>
+class OutOfOrderProcessor : public SimulationEngine {
 private:
+    // Pipeline latch bounds: decode holds up to 2 * width - 1, writeback up to width * 5
+    static const size_t DECODE_LATCH_SIZE = Width ? 2 * Width - 1 : 0;
+    static const size_t WRITEBACK_LATCH_SIZE = Width * WRITEBACK_LATCH_FACTOR;
+
     // Processor Configuration
     ProcessorParameters m_config;  // Stores processor configuration parameters
-    FILE* m_traceFile;             // Input trace file for instruction stream
+    SimulationOptions m_options;   // Engine options (idle-cycle skipping, ...)
+    InstructionSource& m_source;   // Input trace for instruction stream (owned by the caller)
+
+    // In-Flight Instructions: Stored once; every other structure holds arena handles
+    InstructionArena m_arena;
 
-    // Pipeline Stage Buffers
-    std::deque<Instruction> m_decodeBuffer;        // Instructions waiting to be decoded
-    std::deque<Instruction> m_renameBuffer;        // Instructions waiting for register renaming
-    std::deque<Instruction> m_registerReadBuffer;  // Instructions waiting for register read
-    std::deque<Instruction> m_dispatchBuffer;      // Instructions waiting to be dispatched
-    std::deque<Instruction> m_writebackBuffer;     // Instructions completed execution
+    // Pipeline Stage Buffers (arena handles)
+    LatchStorage<DECODE_LATCH_SIZE> m_decodeBuffer;        // Instructions waiting to be decoded
+    LatchStorage<Width> m_renameBuffer;                    // Instructions waiting for register renaming
+    LatchStorage<Width> m_registerReadBuffer;              // Instructions waiting for register read
+    LatchStorage<Width> m_dispatchBuffer;                  // Instructions waiting to be dispatched
+    LatchStorage<WRITEBACK_LATCH_SIZE> m_writebackBuffer;  // Instructions completed execution
 
     // Reorder Buffer: Tracks instructions to ensure program semantics and precise exceptions
-    std::vector<ReorderBufferEntry> m_reorderBuffer;
+    StructureStorage<ReorderBufferEntry, RobSize> m_reorderBuffer;
     int m_robHead;  // Head pointer of Reorder Buffer
     int m_robTail;  // Tail pointer of Reorder Buffer
+    int m_robOccupancy;  // Number of valid Reorder Buffer entries
 
     // Rename Table: Maps architectural registers to renamed registers
     std::vector<RenameTableEntry> m_renameTable;
 
     // Issue Queue: Tracks instructions waiting to be executed
-    std::vector<IssueQueueEntry> m_issueQueue;
-
-    // Execution List: Tracks instructions currently in execution
-    std::vector<ExecutionEntry> m_executionList;
+    StructureStorage<IssueQueueEntry, IqSize> m_issueQueue;
+    int m_iqOccupancy;  // Number of valid Issue Queue entries
+
+    // Free Issue Queue slots, lowest index first (matches the original first-free-slot search)
+    std::priority_queue<int, std::vector<int>, std::greater<int>> m_iqFreeSlots;
+
+    // Wakeup Network: For each producer ROB tag, the consumers that picked up that tag at rename.
+    // Entries are encoded as (consumer arena handle * 2 + source operand index).
+    std::vector<std::vector<int>> m_wakeupLists;
+
+    // Select Logic: Ready bits indexed by ROB slot, so a scan from the ROB head is in age order
+    BitVector m_readyBits;                                    // IQ entries with all sources available
+    std::vector<int> m_newIssueQueueSlots;                    // IQ slots awaiting their issue cycle stamp
+    std::vector<std::pair<int, int>> m_issueCandidates;       // (fetch cycle, IQ slot) of select candidates
+
+    // Execution Units: Timing wheel of in-flight operations indexed by completion cycle
+    std::vector<std::vector<ExecutionEntry>> m_completionWheel;  // A power of two longer than the longest latency
+    uint64_t m_wheelMask;                                        // Wheel slot of a cycle is cycle & m_wheelMask
+    std::deque<ExecutionEntry> m_completedExecutions;  // Finished, waiting for writeback buffer space
+    size_t m_executingCount;                           // Operations occupying function units
+
+    // Function-Unit Pool: lookup tables built from the configured pool. An unpipelined unit stays
+    // busy until its operation leaves execute; a pipelined class only limits issues per cycle.
+    FunctionUnitPool m_pool;                      // Class and latency of every op type
+    size_t m_unitClassCount;                      // Classes in the pool
+    uint32_t m_unitLimit[FU_MAX_CLASSES];         // Units of each class
+    uint32_t m_unitsBusy[FU_MAX_CLASSES];         // Busy units (pipelined: issued this cycle)
+    uint32_t m_unitReleased[FU_MAX_CLASSES];      // 1 if a completion frees its unit (unpipelined), else 0
+    uint32_t m_unitsReserved[FU_MAX_CLASSES];     // Select scratch: units claimed by gathered candidates
 
     // Simulation Metrics
     uint64_t m_instructionCount;  // Total number of instructions processed
+    uint64_t m_retiredCount;      // Instructions committed so far
     uint64_t m_cycleCount;        // Total simulation cycles
     bool m_simulationComplete;    // Flag to indicate simulation completion
+    bool m_progress;              // Some stage changed pipeline state during the current cycle
+
+    // Stall Attribution and Occupancy (only collected with make STATS=1; always present so the
+    // engine layout does not depend on the build flags)
+    PipelineStats m_stats;
+    STATS_HOOK(void recordCycleStats(uint64_t weight);)  // Fold one evaluated cycle into m_stats
+
+    // Geometry: compile-time constants in specializations, else the configuration
+    size_t width() const { return Width ? Width : m_config.width; }
+    size_t robSize() const { return RobSize ? RobSize : m_config.robSize; }
+    size_t iqSize() const { return IqSize ? IqSize : m_config.iqSize; }
+    int nextRobSlot(int slot) const {
+        if (RobSize && (RobSize & (RobSize - 1)) == 0) {
+            return (slot + 1) & (RobSize - 1);
+        }
+        return (slot + 1) % robSize();
+    }
 
     // Private Helper Methods for Resource Status Checks
     bool isReorderBufferFull() const;    // Checks if Reorder Buffer is at capacity
@@ -49,7 +158,9 @@ private:
     bool isIssueQueueFull() const;       // Checks if Issue Queue is at capacity
     bool isIssueQueueEmpty() const;      // Checks if Issue Queue is empty
     bool isInstructionReady(size_t j) const;  // Checks if an instruction is ready to issue
-    bool isExecutionNeeded() const;      // Checks if execution stage needs processing
+
+    // Wakeup Helpers
+    void wakeupDependents(int robTag);   // Clear source tags waiting on a completed producer
 
     // Pipeline Stage Implementations
     void fetchStage();        // Fetch new instructions
@@ -62,6 +173,11 @@ private:
     void writebackStage();    // Write back execution results
     void retireStage();       // Commit instructions in order
 
+    // Event-Driven Fast-Forward
+    bool hasInstructionsInFlight() const;  // Any instruction left in the pipeline
+    void skipIdleCycles(uint64_t cycleLimit);  // Jump towards the cycle before the next completion event, ending no later than cycleLimit (or report deadlock)
+    bool evaluateCycle(uint64_t cycleLimit);   // stepCycle() whose idle jump ends the cycle count no later than cycleLimit
+
     // Utility Methods
     void initializeStructures();  // Initialize processor data structures
     void printInstructionDetails(const Instruction& inst) const;  // Debug print instruction details
@@ -81,19 +197,46 @@ private:
     int countIQEntries() const;   // Count valid entries in Issue Queue
 
 public:
-    // Constructor: Initialize processor with configuration and trace file
+    // Constructor: Initialize processor with configuration and instruction source
     OutOfOrderProcessor(
         const ProcessorParameters& config, 
-        FILE* traceFile
+        InstructionSource& source,
+        const SimulationOptions& options = SimulationOptions()
     );
 
     // Main Simulation Methods
-    void simulate();         // Run complete simulation
+    void simulate() override;
+    bool stepCycle() override;
+    bool runUntilRetired(uint64_t count) override;
+    bool runUntilCycle(uint64_t cycle) override;
+    bool runCycles(uint64_t count) override;
     bool advanceCycle();     // Advance processor by one cycle
-    void printSimulationResults() const;  // Display simulation statistics
+    void printSimulationResults() const override;
+    void printPipelineStats() const override;
+
+    // Checkpointing (checkpoint.cpp)
+    void saveCheckpoint(const std::string& path) const override;
+    void restoreCheckpoint(const std::string& path) override;
+
+    // Simulation Results
+    uint64_t instructionCount() const override { return m_instructionCount; }
+    uint64_t cycleCount() const override { return m_cycleCount; }
+    uint64_t retiredCount() const override { return m_retiredCount; }
+    bool isFinished() const override { return m_simulationComplete && !hasInstructionsInFlight(); }
 
     // Destructor
     ~OutOfOrderProcessor();
 };
 
+// Create the engine for a configuration: a fixed-geometry specialization when one matches (and
+// options.specializeGeometry is set), else the run-time sized engine. Results are identical.
+std::unique_ptr<SimulationEngine> makeProcessor(
+    const ProcessorParameters& config,
+    InstructionSource& source,
+    const SimulationOptions& options = SimulationOptions()
+);
+
+// Check whether makeProcessor() has a fixed-geometry specialization for a configuration
+bool hasSpecializedEngine(const ProcessorParameters& config);
+
 #endif // OUT_OF_ORDER_PROCESSOR_H
\ No newline at end of file
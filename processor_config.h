@@ -5,12 +5,28 @@
 
 using namespace std;
 
+struct FunctionUnitPool;
+
 // Processor Configuration Parameters
 // Defines the key structural constraints and settings for the out-of-order processor
 struct ProcessorParameters {
     uint32_t robSize;    // Size of the Reorder Buffer (maximum entries that can be tracked)
     uint32_t iqSize;     // Size of the Issue Queue (maximum instructions waiting to be executed)
     uint32_t width;      // Processor pipeline width (maximum instructions processed per cycle)
+    const FunctionUnitPool* functionUnits = nullptr;  // Execution resources (owned by the caller; nullptr: the default pool)
+};
+
+class RetireSink;
+
+// Simulation Options
+// Engine settings that change how fast the model runs or what it reports, never what it computes
+struct SimulationOptions {
+    bool skipIdleCycles;     // Jump over cycles in which no pipeline stage can make progress
+    RetireSink* retireSink;  // Receives each retired instruction's timing record (nullptr: no per-instruction output)
+    bool specializeGeometry; // Let makeProcessor() use a compile-time specialized engine for common configurations
+
+    // Default Constructor
+    SimulationOptions() : skipIdleCycles(true), retireSink(nullptr), specializeGeometry(true) {}
 };
 
 // Instruction Representation
@@ -80,18 +96,42 @@ struct RenameTableEntry {
     RenameTableEntry() : valid(false), robTag(-1) {}
 };
 
+// In-Flight Instruction State
+// Hot per-instruction fields read by the scheduling loops (rename, wakeup, select, retire),
+// kept apart from the timing record so each instruction costs a single cache line access.
+struct alignas(32) InstructionState {
+    int destRename;         // Destination ROB slot
+    int src1Rename;         // Outstanding producer ROB tag for source 1 (-1 if available)
+    int src2Rename;         // Outstanding producer ROB tag for source 2 (-1 if available)
+    int iqSlot;             // Issue Queue slot while waiting to issue (-1 otherwise)
+    int fetchCycle;         // Fetch cycle, the primary select age key
+    int16_t destReg;        // Destination Architectural Register
+    int16_t src1Reg;        // First Source Architectural Register
+    int16_t src2Reg;        // Second Source Architectural Register
+    int16_t opType;         // Operation Type
+    uint8_t unitClass;      // Function-unit class executing the operation
+    uint8_t latency;        // Execution latency in cycles
+
+    // Default Constructor
+    InstructionState() :
+        destRename(-1), src1Rename(-1), src2Rename(-1), iqSlot(-1), fetchCycle(-1),
+        destReg(-1), src1Reg(-1), src2Reg(-1), opType(0), unitClass(0), latency(1)
+    {}
+};
+
 // Reorder Buffer Entry
 // Tracks instructions in-flight, ensuring correct program semantics and precise exceptions
 struct ReorderBufferEntry {
     bool valid;             // Indicates if entry is occupied
     bool ready;             // Indicates if instruction is ready to retire
-    Instruction instruction; // Full instruction details
+    int handle;             // Instruction arena handle
     int destArchReg;        // Destination architectural register
 
     // Default Constructor
     ReorderBufferEntry() : 
         valid(false), 
         ready(false), 
+        handle(-1),
         destArchReg(-1) 
     {}
 };
@@ -100,22 +140,22 @@ struct ReorderBufferEntry {
 // Represents an instruction waiting to be issued for execution
 struct IssueQueueEntry {
     bool valid;             // Indicates if entry is occupied
-    Instruction instruction; // Full instruction details
+    int handle;             // Instruction arena handle
 
     // Default Constructor
-    IssueQueueEntry() : valid(false) {}
+    IssueQueueEntry() : valid(false), handle(-1) {}
 };
 
 // Execution Entry
 // Tracks an instruction during its execution phase
 struct ExecutionEntry {
-    Instruction instruction;  // Instruction being executed
-    int remainingCycles;      // Cycles left to complete execution
+    int handle;               // Instruction arena handle of the instruction being executed
+    int latency;              // Execution latency in cycles
 
-    // Constructor with initial instruction and execution cycles
-    ExecutionEntry(const Instruction& inst, int cycles) : 
-        instruction(inst), 
-        remainingCycles(cycles) 
+    // Constructor with instruction handle and execution cycles
+    ExecutionEntry(int inst, int cycles) : 
+        handle(inst), 
+        latency(cycles) 
     {}
 };
 
@@ -0,0 +1,450 @@
+#include <climits>
+#include <stdexcept>
+#include "reference_processor.h"
+#include "processor.h"
+
+ReferenceProcessor::ReferenceProcessor(
+    const ProcessorParameters& config,
+    InstructionSource& source,
+    RetireSink* retireSink
+) :
+    m_config(config),
+    m_pool(config.functionUnits ? *config.functionUnits : FunctionUnitPool()),
+    m_source(source),
+    m_retireSink(retireSink),
+    m_reorderBuffer(config.robSize),
+    m_robHead(0),
+    m_robTail(0),
+    m_renameTable(ARF_SIZE),
+    m_issueQueue(config.iqSize),
+    m_instructionCount(0),
+    m_cycleCount(0)
+{
+    if (config.width == 0 || config.iqSize < config.width || config.robSize < config.width) {
+        throw std::invalid_argument("reference model needs IQ_SIZE and ROB_SIZE of at least WIDTH");
+    }
+    for (size_t unitClass = 0; unitClass < m_pool.classes.size(); unitClass++) {
+        if (m_pool.units(unitClass, config.width) == 0) {
+            throw std::invalid_argument("function unit class " + m_pool.classes[unitClass].name + " has no units");
+        }
+    }
+}
+
+// Main simulation loop: stages in reverse order, one cycle per iteration
+void ReferenceProcessor::simulate() {
+    do {
+        retireStage();
+        writebackStage();
+        executeStage();
+        issueStage();
+        dispatchStage();
+        registerReadStage();
+        renameStage();
+        decodeStage();
+        fetchStage();
+    } while (advanceCycle());
+}
+
+// Fetch stage: Read up to WIDTH new instructions into the decode buffer
+void ReferenceProcessor::fetchStage() {
+    if (m_decodeBuffer.size() >= m_config.width) {
+        return;
+    }
+
+    for (size_t i = 0; i < m_config.width; i++) {
+        TraceRecord record;
+        if (!m_source.next(record)) {
+            return;
+        }
+        if (m_pool.opClass[functionUnitIndex(record.opType)] < 0) {
+            throw std::runtime_error("no function unit executes op type " + std::to_string(record.opType));
+        }
+
+        Instruction instruction;
+        instruction.pc = record.pc;
+        instruction.opType = record.opType;
+        instruction.destReg = record.destReg;
+        instruction.src1Reg = record.src1Reg;
+        instruction.src2Reg = record.src2Reg;
+        instruction.sequenceNum = m_instructionCount++;
+        instruction.fetchCycle = m_cycleCount;
+        instruction.fetchDuration = 1;
+
+        m_decodeBuffer.push_back(instruction);
+    }
+}
+
+// Decode stage
+void ReferenceProcessor::decodeStage() {
+    for (auto& inst : m_decodeBuffer) {
+        if (inst.decodeCycle == -1) {
+            inst.decodeCycle = m_cycleCount;
+        }
+    }
+
+    if (m_renameBuffer.size() == m_config.width) return;
+
+    while (!m_decodeBuffer.empty() && m_renameBuffer.size() < m_config.width) {
+        Instruction inst = m_decodeBuffer.front();
+        inst.decodeDuration = m_cycleCount - inst.decodeCycle + 1;
+        m_renameBuffer.push_back(inst);
+        m_decodeBuffer.pop_front();
+    }
+}
+
+// Rename stage: Allocate ROB entries and update the rename table
+void ReferenceProcessor::renameStage() {
+    for (auto& inst : m_renameBuffer) {
+        if (inst.renameCycle == -1) {
+            inst.renameCycle = m_cycleCount;
+        }
+    }
+
+    if (isReorderBufferFull() || m_registerReadBuffer.size() == m_config.width)
+        return;
+
+    while (!m_renameBuffer.empty() && m_registerReadBuffer.size() < m_config.width) {
+        Instruction inst = m_renameBuffer.front();
+
+        m_reorderBuffer[m_robTail].valid = true;
+        m_reorderBuffer[m_robTail].ready = false;
+        m_reorderBuffer[m_robTail].instruction = inst;
+
+        if (inst.src1Reg != -1 && m_renameTable[inst.src1Reg].valid) {
+            inst.src1Rename = m_renameTable[inst.src1Reg].robTag;
+        }
+
+        if (inst.src2Reg != -1 && m_renameTable[inst.src2Reg].valid) {
+            inst.src2Rename = m_renameTable[inst.src2Reg].robTag;
+        }
+
+        m_reorderBuffer[m_robTail].destArchReg = inst.destReg;
+
+        if (inst.destReg != -1) {
+            m_renameTable[inst.destReg].valid = true;
+            m_renameTable[inst.destReg].robTag = m_robTail;
+        }
+
+        inst.destRename = m_robTail;
+
+        inst.renameDuration = m_cycleCount - inst.renameCycle + 1;
+        m_registerReadBuffer.push_back(inst);
+        m_renameBuffer.pop_front();
+
+        m_robTail = (m_robTail + 1) % m_config.robSize;
+    }
+}
+
+// Register Read stage
+void ReferenceProcessor::registerReadStage() {
+    for (auto& inst : m_registerReadBuffer) {
+        if (inst.regReadCycle == -1) {
+            inst.regReadCycle = m_cycleCount;
+        }
+    }
+
+    if (m_dispatchBuffer.size() == m_config.width)
+        return;
+
+    while (!m_registerReadBuffer.empty() && m_dispatchBuffer.size() < m_config.width) {
+        Instruction inst = m_registerReadBuffer.front();
+
+        if (inst.src1Rename != -1 && m_reorderBuffer[inst.src1Rename].ready) {
+            inst.src1Rename = -1;
+        }
+
+        if (inst.src2Rename != -1 && m_reorderBuffer[inst.src2Rename].ready) {
+            inst.src2Rename = -1;
+        }
+
+        inst.regReadDuration = m_cycleCount - inst.regReadCycle + 1;
+        m_dispatchBuffer.push_back(inst);
+        m_registerReadBuffer.pop_front();
+    }
+}
+
+// Dispatch stage: Move instructions into the lowest free Issue Queue slots
+void ReferenceProcessor::dispatchStage() {
+    for (auto& inst : m_dispatchBuffer) {
+        if (inst.dispatchCycle == -1) {
+            inst.dispatchCycle = m_cycleCount;
+        }
+    }
+
+    if (isIssueQueueFull()) {
+        return;
+    }
+
+    while (!m_dispatchBuffer.empty()) {
+        for (size_t i = 0; i < m_config.iqSize; i++) {
+            if (m_issueQueue[i].valid) continue;
+
+            Instruction& front = m_dispatchBuffer.front();
+            if (front.src1Rename != -1 && m_reorderBuffer[front.src1Rename].ready) {
+                front.src1Rename = -1;
+            }
+            if (front.src2Rename != -1 && m_reorderBuffer[front.src2Rename].ready) {
+                front.src2Rename = -1;
+            }
+
+            front.dispatchDuration = m_cycleCount - front.dispatchCycle + 1;
+            m_issueQueue[i].valid = true;
+            m_issueQueue[i].instruction = front;
+
+            break;
+        }
+
+        m_dispatchBuffer.pop_front();
+    }
+}
+
+// Issue stage: Select up to WIDTH of the oldest ready instructions that find a free function unit
+void ReferenceProcessor::issueStage() {
+    // Pipelined units take a new operation every cycle; unpipelined ones stay busy until their
+    // operation leaves the execution list
+    std::vector<uint32_t> busy = countBusyUnits();
+    bool saturated = true;
+    for (size_t unitClass = 0; unitClass < m_pool.classes.size(); unitClass++) {
+        saturated &= busy[unitClass] == m_pool.units(unitClass, m_config.width);
+    }
+    if (saturated) {
+        return;
+    }
+
+    for (auto& entry : m_issueQueue) {
+        if (entry.valid && entry.instruction.issueCycle == -1) {
+            entry.instruction.issueCycle = m_cycleCount;
+        }
+    }
+
+    for (size_t i = 0; i < m_config.width; i++) {
+        int oldestCycle = INT_MAX;
+        int oldestIdx = -1;
+
+        for (size_t j = 0; j < m_config.iqSize; j++) {
+            if (!m_issueQueue[j].valid) continue;
+            if (m_issueQueue[j].instruction.src1Rename != -1) continue;
+            if (m_issueQueue[j].instruction.src2Rename != -1) continue;
+
+            int unitClass = m_pool.opClass[functionUnitIndex(m_issueQueue[j].instruction.opType)];
+            if (busy[unitClass] == m_pool.units(unitClass, m_config.width)) continue;
+
+            if (m_issueQueue[j].instruction.fetchCycle < oldestCycle) {
+                oldestCycle = m_issueQueue[j].instruction.fetchCycle;
+                oldestIdx = j;
+            }
+        }
+
+        if (oldestIdx == -1) {
+            return;
+        }
+
+        Instruction& inst = m_issueQueue[oldestIdx].instruction;
+        int execLatency = m_pool.opLatency[functionUnitIndex(inst.opType)];
+        busy[m_pool.opClass[functionUnitIndex(inst.opType)]]++;
+
+        inst.issueDuration = m_cycleCount - inst.issueCycle + 1;
+        ExecEntry execEntry = {inst, execLatency};
+        m_executionList.push_back(execEntry);
+
+        m_issueQueue[oldestIdx].valid = false;
+    }
+}
+
+// Execute stage: Count down latencies, broadcast results and move finished work to writeback
+void ReferenceProcessor::executeStage() {
+    if (m_executionList.empty()) {
+        return;
+    }
+
+    for (auto& execEntry : m_executionList) {
+        if (execEntry.instruction.executeCycle == -1) {
+            execEntry.instruction.executeCycle = m_cycleCount;
+        }
+        execEntry.remainingCycles--;
+    }
+
+    while (isExecutionNeeded()) {
+        for (size_t i = 0; i < m_executionList.size(); i++) {
+            if (m_executionList[i].remainingCycles != 0) {
+                continue;
+            }
+            int tag = m_executionList[i].instruction.destRename;
+
+            // Wake up dependents in the Issue Queue (valid or not, as the original did)
+            for (size_t j = 0; j < m_config.iqSize; j++) {
+                Instruction& waiting = m_issueQueue[j].instruction;
+                if (waiting.src1Rename == tag && waiting.src1Rename != -1) {
+                    waiting.src1Rename = -1;
+                }
+                if (waiting.src2Rename == tag && waiting.src2Rename != -1) {
+                    waiting.src2Rename = -1;
+                }
+            }
+
+            // Wake up dependents in the dispatch and register read buffers
+            for (auto& inst : m_dispatchBuffer) {
+                if (inst.src1Rename == tag) {
+                    inst.src1Rename = -1;
+                }
+                if (inst.src2Rename == tag) {
+                    inst.src2Rename = -1;
+                }
+            }
+
+            for (auto& inst : m_registerReadBuffer) {
+                if (inst.src1Rename == tag) {
+                    inst.src1Rename = -1;
+                }
+                if (inst.src2Rename == tag) {
+                    inst.src2Rename = -1;
+                }
+            }
+
+            if (m_writebackBuffer.size() == m_config.width * 5) {
+                return;
+            }
+
+            m_executionList[i].instruction.executeDuration =
+                m_cycleCount - m_executionList[i].instruction.executeCycle + 1;
+            m_executionList[i].instruction.valid = true;
+            m_writebackBuffer.push_back(m_executionList[i].instruction);
+
+            m_executionList.erase(m_executionList.begin() + i);
+        }
+    }
+}
+
+// Writeback stage: Mark the matching ROB entries ready
+void ReferenceProcessor::writebackStage() {
+    for (auto& inst : m_writebackBuffer) {
+        if (inst.writebackCycle == -1) {
+            inst.writebackCycle = m_cycleCount;
+        }
+    }
+
+    while (!m_writebackBuffer.empty()) {
+        for (size_t i = 0; i < m_config.robSize; i++) {
+            if (m_reorderBuffer[i].valid &&
+                m_reorderBuffer[i].instruction.sequenceNum == m_writebackBuffer.front().sequenceNum) {
+                m_reorderBuffer[i].ready = true;
+                m_writebackBuffer.front().writebackDuration =
+                    m_cycleCount - m_writebackBuffer.front().writebackCycle + 1;
+                m_reorderBuffer[i].instruction = m_writebackBuffer.front();
+                m_writebackBuffer.pop_front();
+
+                if (m_writebackBuffer.empty()) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Retire stage: Commit up to WIDTH ready instructions from the ROB head
+void ReferenceProcessor::retireStage() {
+    if (isReorderBufferEmpty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < m_reorderBuffer.size(); i++) {
+        if (m_reorderBuffer[i].ready && m_reorderBuffer[i].instruction.retireCycle == -1) {
+            m_reorderBuffer[i].instruction.retireCycle = m_cycleCount;
+        }
+    }
+
+    for (size_t i = 0; i < m_config.width; i++) {
+        RobEntry& head = m_reorderBuffer[m_robHead];
+        if (head.valid && head.ready) {
+            head.instruction.retireDuration = m_cycleCount - head.instruction.retireCycle + 1;
+
+            if (m_retireSink) {
+                m_retireSink->retire(head.instruction);
+            }
+
+            if (head.instruction.destReg != -1 &&
+                head.instruction.destRename == m_renameTable[head.instruction.destReg].robTag) {
+                m_renameTable[head.instruction.destReg].valid = false;
+                m_renameTable[head.instruction.destReg].robTag = -1;
+            }
+
+            head.valid = false;
+            m_robHead = (m_robHead + 1) % m_config.robSize;
+        }
+    }
+}
+
+// Advance the cycle; returns false once every structure has drained
+bool ReferenceProcessor::advanceCycle() {
+    m_cycleCount++;
+
+    return m_decodeBuffer.size() ||
+           m_renameBuffer.size() ||
+           m_registerReadBuffer.size() ||
+           m_dispatchBuffer.size() ||
+           !isIssueQueueEmpty() ||
+           m_executionList.size() ||
+           m_writebackBuffer.size() ||
+           !isReorderBufferEmpty();
+}
+
+// ROB and IQ are "full" with fewer than WIDTH free entries
+bool ReferenceProcessor::isReorderBufferFull() const {
+    size_t emptySlots = 0;
+    for (const auto& entry : m_reorderBuffer) {
+        if (!entry.valid) {
+            emptySlots++;
+        }
+    }
+    return emptySlots < m_config.width;
+}
+
+bool ReferenceProcessor::isIssueQueueFull() const {
+    size_t emptySlots = 0;
+    for (const auto& entry : m_issueQueue) {
+        if (!entry.valid) {
+            emptySlots++;
+        }
+    }
+    return emptySlots < m_config.width;
+}
+
+bool ReferenceProcessor::isReorderBufferEmpty() const {
+    for (const auto& entry : m_reorderBuffer) {
+        if (entry.valid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReferenceProcessor::isIssueQueueEmpty() const {
+    for (const auto& entry : m_issueQueue) {
+        if (entry.valid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Unpipelined units hold their operation until it moves to writeback
+std::vector<uint32_t> ReferenceProcessor::countBusyUnits() const {
+    std::vector<uint32_t> busy(m_pool.classes.size(), 0);
+    for (const auto& execEntry : m_executionList) {
+        int unitClass = m_pool.opClass[functionUnitIndex(execEntry.instruction.opType)];
+        if (!m_pool.classes[unitClass].pipelined) {
+            busy[unitClass]++;
+        }
+    }
+    return busy;
+}
+
+// Check whether any operation finished executing
+bool ReferenceProcessor::isExecutionNeeded() const {
+    for (const auto& execEntry : m_executionList) {
+        if (execEntry.remainingCycles == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,99 @@
+#ifndef REFERENCE_PROCESSOR_H
+#define REFERENCE_PROCESSOR_H
+
+#include <deque>
+#include <vector>
+#include "function_units.h"
+#include "processor_config.h"
+#include "instruction_source.h"
+#include "retire_log.h"
+
+// ReferenceProcessor: The original, unoptimized pipeline model, a functionally identical copy of
+// the baseline engine apart from its input (an InstructionSource) and output (a RetireSink); the
+// code is reformatted and its comments condensed. Every structure is scanned linearly
+// every cycle, so it is slow, but it is the specification the optimized OutOfOrderProcessor must
+// reproduce cycle for cycle; the regression harness (make check) compares the two.
+// Configurations with IQ_SIZE or ROB_SIZE below WIDTH never dispatch or rename and are rejected.
+// The function units follow config.functionUnits (nullptr: the original pool) as the optimized
+// engine does: issue passes over instructions whose class has no free unit.
+class ReferenceProcessor {
+private:
+    // Pipeline structure entries, holding instruction copies as the original model did
+    struct RobEntry {
+        bool valid;
+        bool ready;
+        Instruction instruction;
+        int destArchReg;
+
+        RobEntry() : valid(false), ready(false), destArchReg(-1) {}
+    };
+
+    struct IqEntry {
+        bool valid;
+        Instruction instruction;
+
+        IqEntry() : valid(false) {}
+    };
+
+    struct ExecEntry {
+        Instruction instruction;
+        int remainingCycles;
+    };
+
+    // Processor Configuration
+    ProcessorParameters m_config;
+    FunctionUnitPool m_pool;      // Unit classes, and the class and latency of each op type
+    InstructionSource& m_source;  // Input trace (owned by the caller)
+    RetireSink* m_retireSink;     // Receives each retired instruction (not owned; may be null)
+
+    // Pipeline Stage Buffers
+    std::deque<Instruction> m_decodeBuffer;
+    std::deque<Instruction> m_renameBuffer;
+    std::deque<Instruction> m_registerReadBuffer;
+    std::deque<Instruction> m_dispatchBuffer;
+    std::deque<Instruction> m_writebackBuffer;
+
+    // Reorder Buffer, Rename Table, Issue Queue and Execution List
+    std::vector<RobEntry> m_reorderBuffer;
+    int m_robHead;
+    int m_robTail;
+    std::vector<RenameTableEntry> m_renameTable;
+    std::vector<IqEntry> m_issueQueue;
+    std::vector<ExecEntry> m_executionList;
+
+    // Simulation Metrics
+    uint64_t m_instructionCount;
+    uint64_t m_cycleCount;
+
+    // Resource Status Checks
+    bool isReorderBufferFull() const;
+    bool isReorderBufferEmpty() const;
+    bool isIssueQueueFull() const;
+    bool isIssueQueueEmpty() const;
+    bool isExecutionNeeded() const;
+    std::vector<uint32_t> countBusyUnits() const;  // Unpipelined units of each class still executing
+
+    // Pipeline Stages
+    void fetchStage();
+    void decodeStage();
+    void renameStage();
+    void registerReadStage();
+    void dispatchStage();
+    void issueStage();
+    void executeStage();
+    void writebackStage();
+    void retireStage();
+
+    bool advanceCycle();
+
+public:
+    ReferenceProcessor(const ProcessorParameters& config, InstructionSource& source, RetireSink* retireSink);
+
+    // Run the whole trace
+    void simulate();
+
+    uint64_t instructionCount() const { return m_instructionCount; }
+    uint64_t cycleCount() const { return m_cycleCount; }
+};
+
+#endif // REFERENCE_PROCESSOR_H
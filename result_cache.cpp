@@ -0,0 +1,190 @@
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "processor.h"
+#include "result_cache.h"
+
+// Index files inside the cache directory
+static const char* const RESULTS_INDEX = "results";
+static const char* const TRACES_INDEX = "traces";
+
+// Simulator model a result was produced by, including a non-default function-unit pool;
+// results from another model never match
+static std::string modelName(const ProcessorParameters& config) {
+    std::string name = "v" + std::to_string(SIMULATOR_VERSION);
+#ifdef PIPELINE_STATS
+    name += "+stats";
+#endif
+    uint64_t pool = config.functionUnits ? config.functionUnits->fingerprint() : 0;
+    if (pool && pool != FunctionUnitPool().fingerprint()) {
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "+fu%016" PRIx64, pool);
+        name += suffix;
+    }
+    return name;
+}
+
+// Whole contents of a file; empty if it does not exist yet
+static std::string readFile(const std::string& path) {
+    std::string contents;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return contents;
+    }
+
+    char buffer[1 << 16];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        contents.append(buffer, count);
+    }
+    fclose(file);
+    return contents;
+}
+
+ResultCache::ResultCache(const std::string& directory) : m_directory(directory) {
+    if (mkdir(m_directory.c_str(), 0777) != 0 && errno != EEXIST) {
+        throw std::runtime_error("could not create result cache " + m_directory + ": " + strerror(errno));
+    }
+}
+
+// Append one record with a single write under an exclusive lock
+void ResultCache::append(const std::string& name, const std::string& record) const {
+    std::string path = m_directory + "/" + name;
+    int fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0666);
+    if (fd < 0) {
+        throw std::runtime_error("could not open result cache index " + path);
+    }
+
+    bool written = flock(fd, LOCK_EX) == 0 &&
+                   write(fd, record.data(), record.size()) == static_cast<ssize_t>(record.size());
+    close(fd);  // Also releases the lock
+    if (!written) {
+        throw std::runtime_error("could not write result cache index " + path);
+    }
+}
+
+// FNV-1a over the file bytes, looked up first by (device, inode, size, modification time)
+uint64_t ResultCache::traceHash(const std::string& path) const {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        throw std::runtime_error("could not open trace file " + path);
+    }
+    uint64_t device = info.st_dev;
+    uint64_t inode = info.st_ino;
+    uint64_t size = info.st_size;
+    uint64_t mtime = static_cast<uint64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+
+    // Remembered hash of the same file version
+    std::string traces = readFile(m_directory + "/" + TRACES_INDEX);
+    uint64_t hash = 0;
+    bool known = false;
+    size_t line = 0;
+    while (line < traces.size()) {
+        size_t end = traces.find('\n', line);
+        if (end == std::string::npos) {
+            break;  // Truncated record
+        }
+
+        uint64_t fields[4];
+        uint64_t recorded;
+        if (sscanf(traces.c_str() + line, "T %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNx64,
+                   &fields[0], &fields[1], &fields[2], &fields[3], &recorded) == 5 &&
+            fields[0] == device && fields[1] == inode && fields[2] == size && fields[3] == mtime) {
+            hash = recorded;
+            known = true;
+        }
+        line = end + 1;
+    }
+    if (known) {
+        return hash;
+    }
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("could not open trace file " + path);
+    }
+    hash = 14695981039346656037ULL;
+    unsigned char buffer[1 << 16];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            hash = (hash ^ buffer[i]) * 1099511628211ULL;
+        }
+    }
+    bool failed = ferror(file) != 0;
+    fclose(file);
+    if (failed) {
+        throw std::runtime_error("could not read trace file " + path);
+    }
+
+    char record[160];
+    snprintf(record, sizeof(record), "T %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %016" PRIx64 "\n",
+             device, inode, size, mtime, hash);
+    append(TRACES_INDEX, record);
+    return hash;
+}
+
+// Scan the results index for the latest complete record with the same key
+bool ResultCache::lookup(uint64_t traceHash, const ProcessorParameters& config, CachedResult& result) const {
+    std::string results = readFile(m_directory + "/" + RESULTS_INDEX);
+    std::string model = modelName(config);
+    bool found = false;
+
+    size_t position = 0;
+    while (position < results.size()) {
+        size_t end = results.find('\n', position);
+        if (end == std::string::npos) {
+            break;
+        }
+
+        uint64_t hash, instructions, cycles, length;
+        uint32_t robSize, iqSize, width;
+        char name[64];
+        bool parsed = sscanf(results.c_str() + position,
+                             "R %" SCNx64 " %" SCNu32 " %" SCNu32 " %" SCNu32 " %63s %" SCNu64 " %" SCNu64 " %" SCNu64,
+                             &hash, &robSize, &iqSize, &width, name, &instructions, &cycles, &length) == 8;
+
+        // The report must end at a newline that is followed by the next record (or the end of the
+        // index) and hold no record header itself; otherwise the record was cut short by an
+        // interrupted writer, and its length would swallow the records appended after it
+        size_t terminator = end + 1 + length;
+        if (!parsed || length >= results.size() || terminator >= results.size() || results[terminator] != '\n' ||
+            (terminator + 1 < results.size() && results.compare(terminator + 1, 2, "R ") != 0) ||
+            results.find("\nR ", end) < terminator) {
+            // Resynchronize on the next record header; an append after a cut-short record starts
+            // in the middle of its last line
+            size_t next = results.find("R ", position + 1);
+            if (next == std::string::npos) {
+                break;
+            }
+            position = next;
+            continue;
+        }
+
+        if (hash == traceHash && robSize == config.robSize && iqSize == config.iqSize &&
+            width == config.width && model == name) {
+            result.instructions = instructions;
+            result.cycles = cycles;
+            result.report = results.substr(end + 1, length);
+            found = true;
+        }
+        position = terminator + 1;
+    }
+    return found;
+}
+
+// Append a result record
+void ResultCache::store(uint64_t traceHash, const ProcessorParameters& config, const CachedResult& result) const {
+    char header[256];
+    snprintf(header, sizeof(header),
+             "R %016" PRIx64 " %" PRIu32 " %" PRIu32 " %" PRIu32 " %s %" PRIu64 " %" PRIu64 " %zu\n",
+             traceHash, config.robSize, config.iqSize, config.width, modelName(config).c_str(),
+             result.instructions, result.cycles, result.report.size());
+    append(RESULTS_INDEX, header + result.report + "\n");
+}
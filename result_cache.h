@@ -0,0 +1,51 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include "processor_config.h"
+
+// Outcome of one complete simulation, as stored in the cache
+struct CachedResult {
+    uint64_t instructions;  // Dynamic instruction count
+    uint64_t cycles;        // Cycles simulated
+    std::string report;     // Summary printed after the configuration (results, plus stall statistics in STATS builds)
+
+    CachedResult() : instructions(0), cycles(0) {}
+};
+
+// ResultCache: On-disk store of simulation results, keyed by the trace contents, the processor
+// configuration and the simulator model (SIMULATOR_VERSION, whether statistics are compiled in and
+// the function-unit pool when it is not the default).
+// The directory holds two append-only indexes, so concurrent simulators can share it:
+//
+//     results  "R <trace hash> <rob> <iq> <width> <model> <instructions> <cycles> <length>\n"
+//              followed by the report (length bytes) and a newline
+//     traces   "T <device> <inode> <size> <mtime ns> <trace hash>\n", so an unchanged trace file
+//              is not hashed again
+//
+// Later records win. A record cut short by an interrupted writer is ignored, wherever it sits;
+// reading resumes at the next record header, even one appended on the same line.
+class ResultCache {
+private:
+    std::string m_directory;
+
+    // Append one record to an index, holding an exclusive lock while writing
+    void append(const std::string& name, const std::string& record) const;
+
+public:
+    // Open (creating if needed) a cache directory; throws if it cannot be created
+    explicit ResultCache(const std::string& directory);
+
+    // 64-bit FNV-1a hash of a trace file's bytes, remembered by file identity and modification
+    // time; throws if the file cannot be read
+    uint64_t traceHash(const std::string& path) const;
+
+    // Find the result of a trace and configuration; false on a miss
+    bool lookup(uint64_t traceHash, const ProcessorParameters& config, CachedResult& result) const;
+
+    // Record a result; throws if the index cannot be written
+    void store(uint64_t traceHash, const ProcessorParameters& config, const CachedResult& result) const;
+};
+
+#endif // RESULT_CACHE_H
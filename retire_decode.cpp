@@ -0,0 +1,32 @@
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include "retire_log.h"
+
+using namespace std;
+
+// Convert a binary retire log back into the per-instruction text output
+int main(int argc, char* argv[]) {
+    // Check for correct number of command-line arguments
+    if (argc != 2) {
+        cerr << "Usage: " << argv[0] << " <binary_retire_log>" << endl;
+        return 1;
+    }
+
+    try {
+        RetireLogReader reader(argv[1]);
+        TextRetireLog text(stdout);
+
+        Instruction inst;
+        while (reader.next(inst)) {
+            text.retire(inst);
+        }
+        text.flush();
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
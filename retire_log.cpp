@@ -0,0 +1,372 @@
+#include <cstring>
+#include <stdexcept>
+#include "retire_log.h"
+
+// Largest encoded binary record: 16 varints of at most 10 bytes plus the flags byte
+#define RETIRE_LOG_MAX_RECORD 192
+
+// Number of stages after fetch whose begin cycle is delta-encoded
+#define RETIRE_LOG_LATER_STAGES 8
+
+// Append a decimal integer
+static inline char* appendInt(char* out, int64_t value) {
+    uint64_t magnitude = value;
+    if (value < 0) {
+        *out++ = '-';
+        magnitude = -static_cast<uint64_t>(value);
+    }
+
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude);
+
+    while (count) {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+// Append a literal string
+static inline char* appendText(char* out, const char* text) {
+    while (*text) {
+        *out++ = *text++;
+    }
+    return out;
+}
+
+// Append "<tag>{<begin>,<duration>} "
+static inline char* appendStage(char* out, const char* tag, int begin, int duration) {
+    out = appendText(out, tag);
+    out = appendInt(out, begin);
+    *out++ = ',';
+    out = appendInt(out, duration);
+    return appendText(out, "} ");
+}
+
+// Format one retired instruction in the per-instruction output format
+size_t formatRetiredInstruction(const Instruction& inst, char* out) {
+    char* p = out;
+    p = appendInt(p, inst.sequenceNum);
+    p = appendText(p, " fu{");
+    p = appendInt(p, inst.opType);
+    p = appendText(p, "} src{");
+    p = appendInt(p, inst.src1Reg);
+    *p++ = ',';
+    p = appendInt(p, inst.src2Reg);
+    p = appendText(p, "} dst{");
+    p = appendInt(p, inst.destReg);
+    p = appendText(p, "} ");
+    p = appendStage(p, "FE{", inst.fetchCycle, inst.fetchDuration);
+    p = appendStage(p, "DE{", inst.decodeCycle, inst.decodeDuration);
+    p = appendStage(p, "RN{", inst.renameCycle, inst.renameDuration);
+    p = appendStage(p, "RR{", inst.regReadCycle, inst.regReadDuration);
+    p = appendStage(p, "DI{", inst.dispatchCycle, inst.dispatchDuration);
+    p = appendStage(p, "IS{", inst.issueCycle, inst.issueDuration);
+    p = appendStage(p, "EX{", inst.executeCycle, inst.executeDuration);
+    p = appendStage(p, "WB{", inst.writebackCycle, inst.writebackDuration);
+    p = appendStage(p, "RT{", inst.retireCycle, inst.retireDuration);
+    *p++ = '\n';
+    return p - out;
+}
+
+// Constructor: Buffer lines for an already open output
+TextRetireLog::TextRetireLog(FILE* file) :
+    m_file(file),
+    m_buffer(RETIRE_LOG_TEXT_BUFFER),
+    m_used(0)
+{
+}
+
+// Destructor: Write out the remaining lines (errors are reported by an explicit flush())
+TextRetireLog::~TextRetireLog() {
+    if (m_used) {
+        fwrite(m_buffer.data(), 1, m_used, m_file);
+    }
+    fflush(m_file);
+}
+
+void TextRetireLog::retire(const Instruction& inst) {
+    if (m_buffer.size() - m_used < RETIRE_LOG_MAX_LINE) {
+        flush();
+    }
+    m_used += formatRetiredInstruction(inst, m_buffer.data() + m_used);
+}
+
+void TextRetireLog::flush() {
+    size_t used = m_used;
+    m_used = 0;
+    if ((used && fwrite(m_buffer.data(), 1, used, m_file) != used) || fflush(m_file) != 0) {
+        throw std::runtime_error("failed writing the retire log");
+    }
+}
+
+// Zigzag-map a signed value so small magnitudes of either sign encode in few bytes
+static inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Append an unsigned LEB128 varint
+static inline uint8_t* putVarint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+// Constructor: Create the log, write its header and start the writer thread
+BinaryRetireLog::BinaryRetireLog(const std::string& path) :
+    m_file(fopen(path.c_str(), "wb")),
+    m_path(path),
+    m_nextSequence(0),
+    m_lastPc(0),
+    m_lastFetchCycle(0),
+    m_blocksInFlight(0),
+    m_closing(false),
+    m_failed(false)
+{
+    if (!m_file) {
+        throw std::runtime_error("could not create retire log " + path);
+    }
+
+    uint8_t header[16] = {0};
+    memcpy(header, RETIRE_LOG_MAGIC, RETIRE_LOG_MAGIC_SIZE);
+    uint32_t version = RETIRE_LOG_VERSION;
+    memcpy(header + RETIRE_LOG_MAGIC_SIZE, &version, sizeof(version));
+    fwrite(header, 1, sizeof(header), m_file);
+
+    m_block.reserve(RETIRE_LOG_BINARY_BUFFER);
+    m_writer = std::thread(&BinaryRetireLog::writerLoop, this);
+}
+
+// Destructor: Drain the queued blocks and stop the writer thread
+BinaryRetireLog::~BinaryRetireLog() {
+    try {
+        flush();
+    }
+    catch (...) {
+        // Reported by an explicit flush(); nothing more to do during destruction
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_blockReady.notify_one();
+    m_writer.join();
+    fclose(m_file);
+}
+
+// Writer thread: Write full blocks in order and return them for reuse
+void BinaryRetireLog::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_blockReady.wait(lock, [this] { return !m_fullBlocks.empty() || m_closing; });
+        if (m_fullBlocks.empty()) {
+            return;
+        }
+
+        std::vector<uint8_t> block = std::move(m_fullBlocks.front());
+        m_fullBlocks.pop_front();
+
+        // Write without holding the lock so the encoder keeps going
+        lock.unlock();
+        bool ok = fwrite(block.data(), 1, block.size(), m_file) == block.size();
+        block.clear();
+        lock.lock();
+
+        m_failed |= !ok;
+        m_spareBlocks.push_back(std::move(block));
+        m_blocksInFlight--;
+        m_blockFree.notify_one();
+    }
+}
+
+// Queue the current block for the writer and continue in a spare one
+void BinaryRetireLog::submitBlock() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // Bound the memory held by blocks waiting for a slow disk
+    m_blockFree.wait(lock, [this] { return m_blocksInFlight < RETIRE_LOG_BINARY_BLOCKS; });
+
+    m_fullBlocks.push_back(std::move(m_block));
+    m_blocksInFlight++;
+    if (!m_spareBlocks.empty()) {
+        m_block = std::move(m_spareBlocks.back());
+        m_spareBlocks.pop_back();
+    }
+    else {
+        m_block = std::vector<uint8_t>();
+        m_block.reserve(RETIRE_LOG_BINARY_BUFFER);
+    }
+    m_blockReady.notify_one();
+}
+
+// Encode one record
+void BinaryRetireLog::retire(const Instruction& inst) {
+    if (m_block.capacity() - m_block.size() < RETIRE_LOG_MAX_RECORD) {
+        submitBlock();
+    }
+
+    uint8_t record[RETIRE_LOG_MAX_RECORD];
+    uint8_t* p = record;
+    p = putVarint(p, zigzag(inst.sequenceNum - m_nextSequence));
+    p = putVarint(p, zigzag(inst.pc - m_lastPc));
+    p = putVarint(p, zigzag(inst.opType));
+    p = putVarint(p, zigzag(inst.destReg));
+    p = putVarint(p, zigzag(inst.src1Reg));
+    p = putVarint(p, zigzag(inst.src2Reg));
+    p = putVarint(p, zigzag(inst.fetchCycle - m_lastFetchCycle));
+
+    // Each stage normally begins when the previous one ends; flag and store the exceptions
+    const int begins[RETIRE_LOG_LATER_STAGES + 1] = {
+        inst.fetchCycle, inst.decodeCycle, inst.renameCycle, inst.regReadCycle, inst.dispatchCycle,
+        inst.issueCycle, inst.executeCycle, inst.writebackCycle, inst.retireCycle
+    };
+    const int durations[RETIRE_LOG_LATER_STAGES + 1] = {
+        inst.fetchDuration, inst.decodeDuration, inst.renameDuration, inst.regReadDuration,
+        inst.dispatchDuration, inst.issueDuration, inst.executeDuration, inst.writebackDuration,
+        inst.retireDuration
+    };
+
+    uint8_t* flags = p++;
+    *flags = 0;
+    for (int stage = 0; stage <= RETIRE_LOG_LATER_STAGES; stage++) {
+        p = putVarint(p, zigzag(durations[stage]));
+    }
+    for (int stage = 1; stage <= RETIRE_LOG_LATER_STAGES; stage++) {
+        int64_t expected = static_cast<int64_t>(begins[stage - 1]) + durations[stage - 1];
+        if (begins[stage] != expected) {
+            *flags |= 1 << (stage - 1);
+            p = putVarint(p, zigzag(begins[stage] - expected));
+        }
+    }
+
+    m_block.insert(m_block.end(), record, p);
+    m_nextSequence = inst.sequenceNum + 1;
+    m_lastPc = inst.pc;
+    m_lastFetchCycle = inst.fetchCycle;
+}
+
+// Hand over the partial block and wait until everything queued is on disk
+void BinaryRetireLog::flush() {
+    if (!m_block.empty()) {
+        submitBlock();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_blockFree.wait(lock, [this] { return m_blocksInFlight == 0; });
+    if (m_failed || fflush(m_file) != 0) {
+        throw std::runtime_error("failed writing retire log " + m_path);
+    }
+}
+
+// Constructor: Open a binary retire log and check its header
+RetireLogReader::RetireLogReader(const std::string& path) :
+    m_file(fopen(path.c_str(), "rb")),
+    m_path(path),
+    m_nextSequence(0),
+    m_lastPc(0),
+    m_lastFetchCycle(0)
+{
+    if (!m_file) {
+        throw std::runtime_error("could not open retire log " + path);
+    }
+
+    uint8_t header[16];
+    uint32_t version = 0;
+    if (fread(header, 1, sizeof(header), m_file) == sizeof(header)) {
+        memcpy(&version, header + RETIRE_LOG_MAGIC_SIZE, sizeof(version));
+    }
+    if (memcmp(header, RETIRE_LOG_MAGIC, RETIRE_LOG_MAGIC_SIZE) != 0 || version != RETIRE_LOG_VERSION) {
+        fclose(m_file);
+        throw std::runtime_error(path + " is not a binary retire log");
+    }
+}
+
+// Destructor: Close the log
+RetireLogReader::~RetireLogReader() {
+    fclose(m_file);
+}
+
+// Read one varint; returns false at a clean end of file
+bool RetireLogReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = getc(m_file);
+        if (byte == EOF) {
+            if (shift == 0) {
+                return false;
+            }
+            break;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    throw std::runtime_error("truncated retire log " + m_path);
+}
+
+// Decode the next record
+bool RetireLogReader::next(Instruction& inst) {
+    uint64_t value;
+    if (!readVarint(value)) {
+        return false;
+    }
+
+    // Every further field must be present
+    auto field = [this, &value]() {
+        if (!readVarint(value)) {
+            throw std::runtime_error("truncated retire log " + m_path);
+        }
+        return unzigzag(value);
+    };
+
+    inst = Instruction();
+    inst.sequenceNum = m_nextSequence + unzigzag(value);
+    inst.pc = m_lastPc + field();
+    inst.opType = field();
+    inst.destReg = field();
+    inst.src1Reg = field();
+    inst.src2Reg = field();
+    inst.fetchCycle = m_lastFetchCycle + field();
+
+    int flags = getc(m_file);
+    if (flags == EOF) {
+        throw std::runtime_error("truncated retire log " + m_path);
+    }
+
+    int* begins[RETIRE_LOG_LATER_STAGES + 1] = {
+        &inst.fetchCycle, &inst.decodeCycle, &inst.renameCycle, &inst.regReadCycle, &inst.dispatchCycle,
+        &inst.issueCycle, &inst.executeCycle, &inst.writebackCycle, &inst.retireCycle
+    };
+    int* durations[RETIRE_LOG_LATER_STAGES + 1] = {
+        &inst.fetchDuration, &inst.decodeDuration, &inst.renameDuration, &inst.regReadDuration,
+        &inst.dispatchDuration, &inst.issueDuration, &inst.executeDuration, &inst.writebackDuration,
+        &inst.retireDuration
+    };
+    for (int stage = 0; stage <= RETIRE_LOG_LATER_STAGES; stage++) {
+        *durations[stage] = field();
+    }
+    for (int stage = 1; stage <= RETIRE_LOG_LATER_STAGES; stage++) {
+        *begins[stage] = *begins[stage - 1] + *durations[stage - 1];
+        if (flags & (1 << (stage - 1))) {
+            *begins[stage] += field();
+        }
+    }
+
+    inst.valid = true;
+    m_nextSequence = inst.sequenceNum + 1;
+    m_lastPc = inst.pc;
+    m_lastFetchCycle = inst.fetchCycle;
+    return true;
+}
@@ -0,0 +1,179 @@
+#ifndef RETIRE_LOG_H
+#define RETIRE_LOG_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "processor_config.h"
+
+// Binary Retire Log Format
+// A 16-byte header (magic, version, reserved) followed by one variable-length record per retired
+// instruction. Fields are LEB128 varints; signed fields are zigzag-encoded deltas from the value
+// they usually equal (previous sequence number + 1, previous PC and fetch cycle, previous stage
+// begin + duration), so a typical record takes about 20 bytes.
+#define RETIRE_LOG_MAGIC "OOORTLOG"
+#define RETIRE_LOG_MAGIC_SIZE 8
+#define RETIRE_LOG_VERSION 1
+
+// Output buffer sizes
+#define RETIRE_LOG_TEXT_BUFFER (1 << 20)    // Text log buffer before each write
+#define RETIRE_LOG_BINARY_BUFFER (4 << 20)  // Binary log block handed to the writer thread
+#define RETIRE_LOG_BINARY_BLOCKS 4          // Blocks in flight between encoder and writer
+
+// Longest formatted text line, with every field at its widest
+#define RETIRE_LOG_MAX_LINE 512
+
+// Format one retired instruction in the per-instruction output format (newline included).
+// Returns the number of characters written; out must hold RETIRE_LOG_MAX_LINE characters.
+size_t formatRetiredInstruction(const Instruction& inst, char* out);
+
+// RetireSink: Receives the timing record of every instruction at retirement, in program order
+class RetireSink {
+public:
+    virtual ~RetireSink() {}
+
+    virtual void retire(const Instruction& inst) = 0;
+
+    // Write out everything buffered so far; throws if output failed
+    virtual void flush() = 0;
+};
+
+// DiscardRetireSink: Drops every record (same effect as no sink, for code that needs an object)
+class DiscardRetireSink : public RetireSink {
+public:
+    void retire(const Instruction&) override {}
+    void flush() override {}
+};
+
+// CountingRetireSink: Counts retired instructions and remembers the last retirement cycle
+class CountingRetireSink : public RetireSink {
+private:
+    uint64_t m_count;
+    int64_t m_lastRetireCycle;  // -1 until the first retirement
+
+public:
+    CountingRetireSink() : m_count(0), m_lastRetireCycle(-1) {}
+
+    void retire(const Instruction& inst) override {
+        m_count++;
+        m_lastRetireCycle = inst.retireCycle;
+    }
+    void flush() override {}
+
+    uint64_t count() const { return m_count; }
+    int64_t lastRetireCycle() const { return m_lastRetireCycle; }
+};
+
+// CallbackRetireSink: Hands every record to a caller-supplied function
+class CallbackRetireSink : public RetireSink {
+private:
+    std::function<void(const Instruction&)> m_callback;
+
+public:
+    explicit CallbackRetireSink(std::function<void(const Instruction&)> callback) :
+        m_callback(std::move(callback))
+    {}
+
+    void retire(const Instruction& inst) override { m_callback(inst); }
+    void flush() override {}
+};
+
+// RetireSinkTee: Forwards every record to two sinks, e.g. the retire log and a pipeline view
+class RetireSinkTee : public RetireSink {
+private:
+    RetireSink& m_first;
+    RetireSink& m_second;
+
+public:
+    RetireSinkTee(RetireSink& first, RetireSink& second) : m_first(first), m_second(second) {}
+
+    void retire(const Instruction& inst) override {
+        m_first.retire(inst);
+        m_second.retire(inst);
+    }
+
+    void flush() override {
+        m_first.flush();
+        m_second.flush();
+    }
+};
+
+// TextRetireLog: The per-instruction text output, formatted into a large buffer and written in
+// blocks instead of flushing a stream after every line
+class TextRetireLog : public RetireSink {
+private:
+    FILE* m_file;               // Output (not owned)
+    std::vector<char> m_buffer; // Formatted lines not yet written
+    size_t m_used;              // Bytes used in m_buffer
+
+public:
+    explicit TextRetireLog(FILE* file);
+    ~TextRetireLog();
+
+    void retire(const Instruction& inst) override;
+    void flush() override;
+};
+
+// BinaryRetireLog: Compact binary records encoded on the simulation thread and written to disk
+// by a background thread, so file I/O overlaps simulation
+class BinaryRetireLog : public RetireSink {
+private:
+    FILE* m_file;                                  // Output file (owned)
+    std::string m_path;                            // Path, for error messages
+    std::vector<uint8_t> m_block;                  // Block being filled by the encoder
+
+    // Encoder state: previous record's fields, the bases of the delta encoding
+    uint64_t m_nextSequence;
+    uint64_t m_lastPc;
+    int64_t m_lastFetchCycle;
+
+    // Hand-off between the encoder and the writer thread
+    std::mutex m_mutex;
+    std::condition_variable m_blockReady;           // Writer: a full block (or close) is waiting
+    std::condition_variable m_blockFree;            // Encoder: a spare block is available
+    std::deque<std::vector<uint8_t>> m_fullBlocks;  // Encoded blocks waiting to be written
+    std::vector<std::vector<uint8_t>> m_spareBlocks;// Written blocks ready for reuse
+    size_t m_blocksInFlight;                        // Blocks queued or being written
+    bool m_closing;                                 // No more blocks will be queued
+    bool m_failed;                                  // A write failed
+    std::thread m_writer;
+
+    void writerLoop();
+    void submitBlock();
+
+public:
+    explicit BinaryRetireLog(const std::string& path);
+    ~BinaryRetireLog();
+
+    void retire(const Instruction& inst) override;
+    void flush() override;
+};
+
+// RetireLogReader: Decodes a binary retire log back into timing records
+class RetireLogReader {
+private:
+    FILE* m_file;        // Input file (owned)
+    std::string m_path;  // Path, for error messages
+
+    // Decoder state, mirroring the encoder
+    uint64_t m_nextSequence;
+    uint64_t m_lastPc;
+    int64_t m_lastFetchCycle;
+
+    bool readVarint(uint64_t& value);
+
+public:
+    explicit RetireLogReader(const std::string& path);
+    ~RetireLogReader();
+
+    // Decode the next record; returns false at the end of the log, throws if it is truncated
+    bool next(Instruction& inst);
+};
+
+#endif // RETIRE_LOG_H
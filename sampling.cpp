@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "sampling.h"
+#include "processor.h"
+
+// Two-sided 95% confidence level
+#define CONFIDENCE_Z 1.96
+
+// WindowInstructionSource: Passes through at most count records of the underlying stream
+class WindowInstructionSource : public InstructionSource {
+private:
+    InstructionSource& m_source;  // Underlying trace
+    uint64_t m_remaining;         // Records still available in the window
+
+public:
+    WindowInstructionSource(InstructionSource& source, uint64_t count) :
+        m_source(source),
+        m_remaining(count)
+    {}
+
+    bool next(TraceRecord& record) override {
+        if (m_remaining == 0 || !m_source.next(record)) {
+            return false;
+        }
+        m_remaining--;
+        return true;
+    }
+};
+
+// Simulate warmup + measured instructions on a fresh pipeline.
+// Fast-forwarding leaves no timing state behind in this model: every skipped instruction has
+// completed, so the warm rename table maps every register to the architectural file, which is
+// exactly the reset state. Only the pipeline itself is cold, which the detailed warmup covers.
+// Younger instructions never delay older ones (select is oldest first and retirement in order),
+// so ending the window at the last measured instruction does not bias its timing.
+static bool simulateSample(
+    InstructionSource& source,
+    const ProcessorParameters& config,
+    const SimulationOptions& options,
+    uint64_t start,
+    uint64_t warmup,
+    uint64_t length,
+    double weight,
+    SampledEstimate& estimate
+) {
+    WindowInstructionSource window(source, warmup + length);
+    std::unique_ptr<SimulationEngine> processor = makeProcessor(config, window, options);
+
+    // Measurement starts once the warmup instructions have retired
+    if (!processor->runUntilRetired(warmup)) {
+        estimate.detailedInstructions += processor->retiredCount();
+        return false;
+    }
+    uint64_t startCycle = processor->cycleCount();
+    uint64_t startRetired = processor->retiredCount();
+
+    bool complete = processor->runUntilRetired(warmup + length);
+    estimate.detailedInstructions += processor->retiredCount();
+    if (!complete) {
+        return false;
+    }
+
+    SampleResult sample;
+    sample.start = start;
+    sample.instructions = processor->retiredCount() - startRetired;
+    sample.cycles = processor->cycleCount() - startCycle;
+    sample.weight = weight;
+    estimate.samples.push_back(sample);
+    return true;
+}
+
+// Start an empty estimate
+static SampledEstimate makeEstimate() {
+    SampledEstimate estimate;
+    estimate.fastForwardedInstructions = 0;
+    estimate.detailedInstructions = 0;
+    estimate.cpi = 0.0;
+    estimate.cpiHalfWidth = 0.0;
+    estimate.hasConfidenceInterval = false;
+    return estimate;
+}
+
+// Simulate evenly spaced samples of the trace and estimate CPI with a 95% confidence interval
+SampledEstimate runSystematicSampling(
+    InstructionSource& source,
+    const ProcessorParameters& config,
+    const SamplingParameters& sampling,
+    SimulationOptions options
+) {
+    if (sampling.sampleSize == 0 || sampling.period < sampling.sampleSize + sampling.warmup) {
+        throw std::invalid_argument("sampling period must cover the warmup and sample size");
+    }
+    options.retireSink = nullptr;  // Samples produce no per-instruction output
+
+    SampledEstimate estimate = makeEstimate();
+    uint64_t fastForward = sampling.period - sampling.sampleSize - sampling.warmup;
+
+    // The measured sample sits at the end of each period; a partial last period is dropped
+    for (uint64_t periodStart = 0; ; periodStart += sampling.period) {
+        uint64_t skipped = source.skip(fastForward);
+        estimate.fastForwardedInstructions += skipped;
+        if (skipped < fastForward) {
+            break;
+        }
+
+        uint64_t sampleStart = periodStart + fastForward + sampling.warmup;
+        if (!simulateSample(source, config, options, sampleStart, sampling.warmup,
+                            sampling.sampleSize, 1.0, estimate)) {
+            break;
+        }
+    }
+
+    if (estimate.samples.empty()) {
+        throw std::runtime_error("trace is shorter than one sampling period");
+    }
+
+    // Every sample measures the same number of instructions, so the estimate is the mean CPI
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (const SampleResult& sample : estimate.samples) {
+        double cpi = static_cast<double>(sample.cycles) / sample.instructions;
+        sum += cpi;
+        sumSquares += cpi * cpi;
+    }
+
+    size_t n = estimate.samples.size();
+    estimate.cpi = sum / n;
+    if (n > 1) {
+        double variance = std::max(0.0, (sumSquares - n * estimate.cpi * estimate.cpi) / (n - 1));
+        estimate.cpiHalfWidth = CONFIDENCE_Z * std::sqrt(variance / n);
+        estimate.hasConfidenceInterval = true;
+    }
+    return estimate;
+}
+
+// Simulate the given representative intervals and combine them by weight
+SampledEstimate runIntervalSampling(
+    InstructionSource& source,
+    const ProcessorParameters& config,
+    std::vector<SimulationInterval> intervals,
+    uint64_t warmup,
+    SimulationOptions options
+) {
+    options.retireSink = nullptr;  // Samples produce no per-instruction output
+
+    // The trace is streamed once, so intervals are visited in program order
+    std::sort(intervals.begin(), intervals.end(),
+              [](const SimulationInterval& a, const SimulationInterval& b) { return a.start < b.start; });
+
+    SampledEstimate estimate = makeEstimate();
+    uint64_t position = 0;
+    double totalWeight = 0.0;
+    double weightedCpi = 0.0;
+
+    for (const SimulationInterval& interval : intervals) {
+        if (interval.start < position) {
+            throw std::invalid_argument("simulation intervals overlap");
+        }
+
+        // Warm up on the instructions just before the interval, as far as they exist
+        uint64_t intervalWarmup = std::min(warmup, interval.start - position);
+        uint64_t fastForward = interval.start - position - intervalWarmup;
+        uint64_t skipped = source.skip(fastForward);
+        estimate.fastForwardedInstructions += skipped;
+        if (skipped < fastForward ||
+            !simulateSample(source, config, options, interval.start, intervalWarmup,
+                            interval.length, interval.weight, estimate)) {
+            throw std::runtime_error("simulation interval starting at " +
+                                     std::to_string(interval.start) + " extends past the end of the trace");
+        }
+        position = interval.start + interval.length;
+
+        const SampleResult& sample = estimate.samples.back();
+        weightedCpi += interval.weight * sample.cycles / sample.instructions;
+        totalWeight += interval.weight;
+    }
+
+    if (estimate.samples.empty() || totalWeight <= 0.0) {
+        throw std::runtime_error("no weighted simulation intervals");
+    }
+    estimate.cpi = weightedCpi / totalWeight;
+    return estimate;
+}
+
+// Read "<start> <length> <weight>" lines ('#' starts a comment); throws on malformed files
+std::vector<SimulationInterval> loadSimulationIntervals(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("could not open interval file " + path);
+    }
+
+    std::vector<SimulationInterval> intervals;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(file, line); lineNumber++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        SimulationInterval interval;
+        if (!(fields >> interval.start)) {
+            continue;  // Blank or comment-only line
+        }
+
+        std::string extra;
+        if (!(fields >> interval.length >> interval.weight) || (fields >> extra) ||
+            interval.length == 0 || interval.weight < 0.0) {
+            throw std::runtime_error("malformed interval on line " + std::to_string(lineNumber) +
+                                     " of " + path);
+        }
+        intervals.push_back(interval);
+    }
+    return intervals;
+}
+
+// Display the sampled estimate in the style of the full-simulation results
+void printSampledResults(const SampledEstimate& estimate) {
+    double ipc = 1.0 / estimate.cpi;
+
+    std::cout << "# === Sampled Simulation Results ="     << std::endl;
+    std::cout << "# Samples                        = "   << estimate.samples.size() << std::endl;
+    std::cout << "# Detailed Instructions          = "   << estimate.detailedInstructions << std::endl;
+    std::cout << "# Fast-Forwarded Instructions    = "   << estimate.fastForwardedInstructions << std::endl;
+    std::cout << "# Instructions Per Cycle (IPC)   = "
+              << std::fixed << std::setprecision(2) << ipc << std::endl;
+
+    if (estimate.hasConfidenceInterval) {
+        // The interval on CPI maps to an interval on IPC through the reciprocal
+        double low = 1.0 / (estimate.cpi + estimate.cpiHalfWidth);
+        double high = estimate.cpiHalfWidth < estimate.cpi ? 1.0 / (estimate.cpi - estimate.cpiHalfWidth) : INFINITY;
+        std::cout << "# IPC 95% Confidence Interval    = ["
+                  << std::fixed << std::setprecision(2) << low << ", " << high << "] (+/- "
+                  << std::setprecision(1) << 100.0 * estimate.cpiHalfWidth / estimate.cpi << "%)" << std::endl;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <string>
+#include <vector>
+#include "instruction_source.h"
+#include "processor_config.h"
+
+// Default detailed-simulation lengths (in instructions) for sampled runs
+#define DEFAULT_SAMPLE_SIZE 1000
+#define DEFAULT_SAMPLE_WARMUP 2000
+
+// Systematic Sampling Parameters (SMARTS-style)
+// The trace is divided into periods; each period fast-forwards, simulates warmup instructions in
+// detail to fill the pipeline, then measures sampleSize instructions at its end.
+struct SamplingParameters {
+    uint64_t period;      // Instructions per sampling period
+    uint64_t sampleSize;  // Measured instructions per sample
+    uint64_t warmup;      // Detailed warmup instructions simulated before each sample
+
+    // Default Constructor
+    SamplingParameters() : period(0), sampleSize(DEFAULT_SAMPLE_SIZE), warmup(DEFAULT_SAMPLE_WARMUP) {}
+};
+
+// Representative Interval (SimPoint-style)
+struct SimulationInterval {
+    uint64_t start;   // Index of the first instruction in the interval
+    uint64_t length;  // Number of instructions in the interval
+    double weight;    // Fraction of the whole program the interval represents
+};
+
+// Measurement of one simulated sample or interval
+struct SampleResult {
+    uint64_t start;         // Index of the first measured instruction
+    uint64_t instructions;  // Instructions retired in the measured window
+    uint64_t cycles;        // Cycles between the end of warmup and the last measured retirement
+    double weight;          // Weight of the sample in the estimate
+};
+
+// Whole-program estimate assembled from the samples
+struct SampledEstimate {
+    std::vector<SampleResult> samples;
+    uint64_t fastForwardedInstructions;  // Instructions skipped without detailed simulation
+    uint64_t detailedInstructions;       // Instructions simulated in detail (warmup and measured)
+    double cpi;                          // Estimated cycles per instruction
+    double cpiHalfWidth;                 // Half-width of the 95% confidence interval on CPI (0 if unknown)
+    bool hasConfidenceInterval;          // Systematic samples support an interval; weighted intervals do not
+};
+
+// Simulate evenly spaced samples of the trace and estimate CPI with a 95% confidence interval
+SampledEstimate runSystematicSampling(
+    InstructionSource& source,
+    const ProcessorParameters& config,
+    const SamplingParameters& sampling,
+    SimulationOptions options
+);
+
+// Simulate the given representative intervals and combine them by weight
+SampledEstimate runIntervalSampling(
+    InstructionSource& source,
+    const ProcessorParameters& config,
+    std::vector<SimulationInterval> intervals,
+    uint64_t warmup,
+    SimulationOptions options
+);
+
+// Read "<start> <length> <weight>" lines ('#' starts a comment); throws on malformed files
+std::vector<SimulationInterval> loadSimulationIntervals(const std::string& path);
+
+// Display the sampled estimate in the style of the full-simulation results
+void printSampledResults(const SampledEstimate& estimate);
+
+#endif // SAMPLING_H
@@ -0,0 +1,254 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "processor.h"
+#include "trace_gen.h"
+
+// Default generated trace length (instructions per pattern)
+#define BENCH_DEFAULT_LENGTH 200000
+
+// Configurations benchmarked against every pattern: ROB_SIZE, IQ_SIZE, WIDTH
+static const size_t BENCH_CONFIGS[][3] = {
+    {32, 16, 2},
+    {128, 32, 4},
+    {256, 64, 4},
+    {512, 128, 8},
+    {1024, 256, 8},
+    {2048, 512, 16},
+    {2048, 2048, 16},
+};
+
+// Outcome of one benchmark run
+struct BenchResult {
+    TracePattern pattern;
+    ProcessorParameters config;
+    bool specialized;    // Ran on a fixed-geometry engine
+    uint64_t instructions;
+    uint64_t cycles;
+    double seconds;      // Wall-clock time of the simulation alone (trace generation excluded)
+    long peakRssKb;      // Peak resident set of the process that ran it
+    std::string error;   // Empty when the run completed
+};
+
+// Measurements the child process sends back through its pipe
+struct BenchMeasurement {
+    uint64_t instructions;
+    uint64_t cycles;
+    double seconds;
+    int failed;
+};
+
+// Print command-line usage
+static void printUsage(const char* program) {
+    cerr << "Usage: " << program << " [options]" << endl
+         << "Options:" << endl
+         << "  --length N       Instructions per generated trace (default " << BENCH_DEFAULT_LENGTH << ")" << endl
+         << "  --pattern NAME   Only run one pattern: chain, parallel, latency-mix or register-pressure" << endl
+         << "  --format F       Results format: csv (default) or json" << endl
+         << "  --output FILE    Write the results to FILE instead of stdout" << endl
+         << "  --no-skip-idle   Evaluate every cycle instead of jumping over idle stretches" << endl
+         << "  --no-specialize  Use the run-time sized engine even for precompiled configurations" << endl;
+}
+
+// Simulate one configuration in a forked child, so each run reports its own peak RSS
+static BenchResult runBenchmark(
+    TracePattern pattern,
+    const std::vector<TraceRecord>& trace,
+    const ProcessorParameters& config,
+    const SimulationOptions& options
+) {
+    BenchResult result;
+    result.pattern = pattern;
+    result.config = config;
+    result.specialized = options.specializeGeometry && hasSpecializedEngine(config);
+    result.instructions = 0;
+    result.cycles = 0;
+    result.seconds = 0.0;
+    result.peakRssKb = 0;
+
+    int channel[2];
+    if (pipe(channel) != 0) {
+        result.error = "pipe failed";
+        return result;
+    }
+
+    cout.flush();
+    pid_t child = fork();
+    if (child < 0) {
+        close(channel[0]);
+        close(channel[1]);
+        result.error = "fork failed";
+        return result;
+    }
+
+    if (child == 0) {
+        close(channel[0]);
+        BenchMeasurement measurement = {0, 0, 0.0, 0};
+        try {
+            MemoryInstructionSource source(trace);
+            std::unique_ptr<SimulationEngine> processor = makeProcessor(config, source, options);
+            auto start = std::chrono::steady_clock::now();
+            processor->simulate();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            measurement.instructions = processor->instructionCount();
+            measurement.cycles = processor->cycleCount();
+            measurement.seconds = elapsed.count();
+        }
+        catch (const exception&) {
+            measurement.failed = 1;
+        }
+        ssize_t written = write(channel[1], &measurement, sizeof(measurement));
+        _exit(written == sizeof(measurement) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    BenchMeasurement measurement;
+    ssize_t received = read(channel[0], &measurement, sizeof(measurement));
+    close(channel[0]);
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) < 0 || received != sizeof(measurement) ||
+        !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        result.error = "benchmark process failed";
+        return result;
+    }
+    if (measurement.failed) {
+        result.error = "simulation failed";
+        return result;
+    }
+
+    result.instructions = measurement.instructions;
+    result.cycles = measurement.cycles;
+    result.seconds = measurement.seconds;
+    result.peakRssKb = usage.ru_maxrss;  // Kilobytes on Linux
+    return result;
+}
+
+// Write the results, one row per pattern and configuration
+static void writeResults(ostream& out, const std::vector<BenchResult>& results, bool json) {
+    if (json) {
+        out << "[" << endl;
+    }
+    else {
+        out << "pattern,rob_size,iq_size,width,specialized,instructions,cycles,seconds,"
+               "instructions_per_sec,cycles_per_sec,peak_rss_kb,error" << endl;
+    }
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        double instructionRate = result.seconds > 0.0 ? result.instructions / result.seconds : 0.0;
+        double cycleRate = result.seconds > 0.0 ? result.cycles / result.seconds : 0.0;
+
+        if (json) {
+            out << "  {\"pattern\": \"" << tracePatternName(result.pattern) << "\""
+                << ", \"rob_size\": " << result.config.robSize
+                << ", \"iq_size\": " << result.config.iqSize
+                << ", \"width\": " << result.config.width
+                << ", \"specialized\": " << (result.specialized ? "true" : "false")
+                << ", \"instructions\": " << result.instructions
+                << ", \"cycles\": " << result.cycles
+                << ", \"seconds\": " << fixed << setprecision(6) << result.seconds
+                << ", \"instructions_per_sec\": " << setprecision(0) << instructionRate
+                << ", \"cycles_per_sec\": " << cycleRate
+                << ", \"peak_rss_kb\": " << result.peakRssKb
+                << ", \"error\": " << (result.error.empty() ? "null" : "\"" + result.error + "\"")
+                << "}" << (i + 1 < results.size() ? "," : "") << endl;
+        }
+        else {
+            out << tracePatternName(result.pattern) << ","
+                << result.config.robSize << ","
+                << result.config.iqSize << ","
+                << result.config.width << ","
+                << (result.specialized ? 1 : 0) << ","
+                << result.instructions << ","
+                << result.cycles << ","
+                << fixed << setprecision(6) << result.seconds << ","
+                << setprecision(0) << instructionRate << ","
+                << cycleRate << ","
+                << result.peakRssKb << ","
+                << result.error << endl;
+        }
+    }
+
+    if (json) {
+        out << "]" << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t length = BENCH_DEFAULT_LENGTH;
+    std::vector<TracePattern> patterns(std::begin(ALL_TRACE_PATTERNS), std::end(ALL_TRACE_PATTERNS));
+    bool json = false;
+    string outputPath;
+    SimulationOptions options;  // No per-instruction output
+
+    for (int argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--length") == 0 && argi + 1 < argc) {
+            length = stoull(argv[++argi]);
+        }
+        else if (strcmp(argv[argi], "--pattern") == 0 && argi + 1 < argc) {
+            TracePattern pattern;
+            if (!parseTracePattern(argv[++argi], pattern)) {
+                cerr << "Error: Unknown pattern " << argv[argi] << endl;
+                return 1;
+            }
+            patterns.assign(1, pattern);
+        }
+        else if (strcmp(argv[argi], "--format") == 0 && argi + 1 < argc) {
+            string format = argv[++argi];
+            if (format != "csv" && format != "json") {
+                cerr << "Error: Unknown format " << format << endl;
+                return 1;
+            }
+            json = format == "json";
+        }
+        else if (strcmp(argv[argi], "--output") == 0 && argi + 1 < argc) {
+            outputPath = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--no-skip-idle") == 0) {
+            options.skipIdleCycles = false;
+        }
+        else if (strcmp(argv[argi], "--no-specialize") == 0) {
+            options.specializeGeometry = false;
+        }
+        else {
+            cerr << "Error: Unknown option " << argv[argi] << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Runs are sequential so they do not compete for cores or memory bandwidth
+    std::vector<BenchResult> results;
+    for (TracePattern pattern : patterns) {
+        std::vector<TraceRecord> trace = generateTrace(pattern, length);
+        for (const auto& size : BENCH_CONFIGS) {
+            ProcessorParameters config;
+            config.robSize = size[0];
+            config.iqSize = size[1];
+            config.width = size[2];
+            results.push_back(runBenchmark(pattern, trace, config, options));
+        }
+    }
+
+    if (outputPath.empty()) {
+        writeResults(cout, results, json);
+    }
+    else {
+        ofstream output(outputPath);
+        writeResults(output, results, json);
+        if (!output) {
+            cerr << "Error: Could not write results to " << outputPath << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,395 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "batch_simulator.h"
+#include "processor.h"
+#include "prefetch_source.h"
+#include "reference_processor.h"
+#include "retire_log.h"
+#include "trace_gen.h"
+#include "work_stealing_pool.h"
+
+// Default generated trace length (instructions per pattern)
+#define CHECK_DEFAULT_LENGTH 20000
+
+// Configurations checked against every trace: ROB_SIZE, IQ_SIZE, WIDTH. They cover single-issue,
+// non-power-of-two widths, IQ_SIZE equal to WIDTH, an IQ much smaller than the ROB and wide
+// machines where the function units (WIDTH * 5 entries) saturate.
+static const size_t CHECK_CONFIGS[][3] = {
+    {8, 4, 2},
+    {10, 5, 5},
+    {16, 8, 1},
+    {32, 16, 2},
+    {60, 15, 3},
+    {64, 32, 4},
+    {128, 64, 8},
+    {256, 128, 8},
+    {512, 256, 16},
+    {1024, 32, 4},
+};
+
+// Function-unit pools checked with every configuration: the original pool, and a mixed one whose
+// per-class limits bind. Its ALUs are a fixed count and its multipliers scale with WIDTH, both
+// pipelined; the single divider is unpipelined with a long latency.
+enum class CheckPool {
+    Default,
+    Mixed
+};
+
+static const CheckPool ALL_CHECK_POOLS[] = { CheckPool::Default, CheckPool::Mixed };
+
+static const char* checkPoolName(CheckPool pool) {
+    return pool == CheckPool::Default ? "default-fu" : "mixed-fu";
+}
+
+static FunctionUnitPool checkFunctionUnitPool(CheckPool pool) {
+    FunctionUnitPool units;
+    if (pool == CheckPool::Mixed) {
+        units.classes = {
+            {"alu", 2, false, true},
+            {"mul", 1, true, true},
+            {"div", 1, false, false},
+        };
+        for (size_t type = 0; type <= FU_OP_TYPES; type++) {
+            units.opClass[type] = 0;
+            units.opLatency[type] = 1;
+        }
+        units.opClass[1] = 1;
+        units.opLatency[1] = 3;
+        units.opClass[2] = 2;
+        units.opLatency[2] = 12;
+    }
+    return units;
+}
+
+// Ways of running the optimized engine; each must reproduce the reference exactly
+enum class CheckMode {
+    Default,     // Idle-cycle skipping, in-memory trace, fixed-geometry engine where one exists
+    Generic,     // Run-time sized engine only
+    NoSkipIdle,  // Every cycle evaluated
+    Prefetch,    // Trace decoded by a producer thread
+    Checkpoint,  // Stopped half way, checkpointed, and resumed on a fresh processor
+    BinaryLog,   // Records round-tripped through the binary retire log
+    Batch        // In lockstep with narrower and wider configurations over a shared trace window
+};
+
+static const CheckMode ALL_CHECK_MODES[] = {
+    CheckMode::Default, CheckMode::Generic, CheckMode::NoSkipIdle, CheckMode::Prefetch, CheckMode::Checkpoint, CheckMode::BinaryLog,
+    CheckMode::Batch
+};
+
+static const char* checkModeName(CheckMode mode) {
+    switch (mode) {
+        case CheckMode::Default:    return "default";
+        case CheckMode::Generic:    return "generic";
+        case CheckMode::NoSkipIdle: return "no-skip-idle";
+        case CheckMode::Prefetch:   return "prefetch";
+        case CheckMode::Checkpoint: return "checkpoint";
+        case CheckMode::BinaryLog:  return "binary-log";
+        case CheckMode::Batch:      return "batch";
+    }
+    return "unknown";
+}
+
+// Configurations batched with the one under test, fetching slower and faster than most, and the
+// records per lockstep round (small, so the shared window slides many times)
+static const size_t BATCH_COMPANIONS[][3] = {
+    {16, 8, 1},
+    {512, 256, 16},
+};
+#define CHECK_BATCH_WINDOW 64
+
+// A trace under test
+struct CheckTrace {
+    std::string name;
+    std::vector<TraceRecord> records;
+};
+
+// RecordingSink: Keeps every retired instruction
+class RecordingSink : public RetireSink {
+public:
+    std::vector<Instruction> records;
+
+    void retire(const Instruction& inst) override { records.push_back(inst); }
+    void flush() override {}
+};
+
+// Outcome of one engine run
+struct EngineRun {
+    std::vector<Instruction> retired;
+    uint64_t instructions;
+    uint64_t cycles;
+};
+
+// Scratch file for one job, removed by the caller
+static std::string scratchPath(size_t job, const char* suffix) {
+    const char* directory = getenv("TMPDIR");
+    return std::string(directory ? directory : P_tmpdir) + "/sim_check." + std::to_string(getpid()) +
+           "." + std::to_string(job) + suffix;
+}
+
+// Run the optimized engine in one mode
+static EngineRun runEngine(const std::vector<TraceRecord>& trace, const ProcessorParameters& config,
+                           CheckMode mode, uint64_t referenceCycles, size_t job) {
+    RecordingSink sink;
+    SimulationOptions options;
+    options.skipIdleCycles = mode != CheckMode::NoSkipIdle;
+    options.specializeGeometry = mode != CheckMode::Generic;
+    options.retireSink = &sink;
+
+    EngineRun run;
+    if (mode == CheckMode::Prefetch) {
+        std::unique_ptr<InstructionSource> memory(new MemoryInstructionSource(trace));
+        PrefetchInstructionSource source(std::move(memory), 1024);
+        std::unique_ptr<SimulationEngine> processor = makeProcessor(config, source, options);
+        processor->simulate();
+        run.instructions = processor->instructionCount();
+        run.cycles = processor->cycleCount();
+    }
+    else if (mode == CheckMode::Checkpoint) {
+        std::string path = scratchPath(job, ".ckpt");
+        MemoryInstructionSource first(trace);
+        std::unique_ptr<SimulationEngine> stopped = makeProcessor(config, first, options);
+        bool running = stopped->runUntilCycle(referenceCycles / 2);
+        if (running) {
+            // An idle stretch across the stop cycle must be cut short, not jumped past
+            if (stopped->cycleCount() != referenceCycles / 2) {
+                throw std::runtime_error("checkpoint run stopped at cycle " + std::to_string(stopped->cycleCount()) +
+                                         " instead of " + std::to_string(referenceCycles / 2));
+            }
+            stopped->saveCheckpoint(path);
+        }
+
+        // Resume on the other engine kind, so checkpoints are checked to be interchangeable
+        MemoryInstructionSource second(trace);
+        options.specializeGeometry = false;
+        std::unique_ptr<SimulationEngine> resumed = makeProcessor(config, second, options);
+        if (running) {
+            resumed->restoreCheckpoint(path);
+            remove(path.c_str());
+        }
+        else {
+            sink.records.clear();  // Trace too short to stop; rerun it whole
+        }
+        resumed->simulate();
+        run.instructions = resumed->instructionCount();
+        run.cycles = resumed->cycleCount();
+    }
+    else if (mode == CheckMode::BinaryLog) {
+        std::string path = scratchPath(job, ".rlog");
+        {
+            BinaryRetireLog log(path);
+            options.retireSink = &log;
+            MemoryInstructionSource source(trace);
+            std::unique_ptr<SimulationEngine> processor = makeProcessor(config, source, options);
+            processor->simulate();
+            log.flush();
+            run.instructions = processor->instructionCount();
+            run.cycles = processor->cycleCount();
+        }
+        RetireLogReader reader(path);
+        Instruction inst;
+        while (reader.next(inst)) {
+            sink.records.push_back(inst);
+        }
+        remove(path.c_str());
+    }
+    else if (mode == CheckMode::Batch) {
+        MemoryInstructionSource source(trace);
+        BatchSimulator batch(source, options, CHECK_BATCH_WINDOW);
+        size_t index = batch.addConfiguration(config, &sink);
+        for (const size_t* size : BATCH_COMPANIONS) {
+            ProcessorParameters companion;
+            companion.robSize = size[0];
+            companion.iqSize = size[1];
+            companion.width = size[2];
+            companion.functionUnits = config.functionUnits;
+            batch.addConfiguration(companion);
+        }
+        batch.simulate();
+        if (!batch.error(index).empty()) {
+            throw std::runtime_error(batch.error(index));
+        }
+        run.instructions = batch.instructionCount(index);
+        run.cycles = batch.cycleCount(index);
+    }
+    else {
+        MemoryInstructionSource source(trace);
+        std::unique_ptr<SimulationEngine> processor = makeProcessor(config, source, options);
+        processor->simulate();
+        run.instructions = processor->instructionCount();
+        run.cycles = processor->cycleCount();
+    }
+
+    run.retired.swap(sink.records);
+    return run;
+}
+
+// Compare the fields of the per-instruction output
+static bool sameRecord(const Instruction& a, const Instruction& b) {
+    return a.sequenceNum == b.sequenceNum && a.opType == b.opType &&
+           a.src1Reg == b.src1Reg && a.src2Reg == b.src2Reg && a.destReg == b.destReg &&
+           a.fetchCycle == b.fetchCycle && a.fetchDuration == b.fetchDuration &&
+           a.decodeCycle == b.decodeCycle && a.decodeDuration == b.decodeDuration &&
+           a.renameCycle == b.renameCycle && a.renameDuration == b.renameDuration &&
+           a.regReadCycle == b.regReadCycle && a.regReadDuration == b.regReadDuration &&
+           a.dispatchCycle == b.dispatchCycle && a.dispatchDuration == b.dispatchDuration &&
+           a.issueCycle == b.issueCycle && a.issueDuration == b.issueDuration &&
+           a.executeCycle == b.executeCycle && a.executeDuration == b.executeDuration &&
+           a.writebackCycle == b.writebackCycle && a.writebackDuration == b.writebackDuration &&
+           a.retireCycle == b.retireCycle && a.retireDuration == b.retireDuration;
+}
+
+// Formatted per-instruction line without its trailing newline
+static std::string formatLine(const Instruction& inst) {
+    char line[RETIRE_LOG_MAX_LINE];
+    size_t length = formatRetiredInstruction(inst, line);
+    return std::string(line, length - 1);
+}
+
+// Describe the first difference between two runs; empty if they match
+static std::string compareRuns(const EngineRun& expected, const EngineRun& actual) {
+    std::ostringstream report;
+    size_t common = std::min(expected.retired.size(), actual.retired.size());
+    for (size_t i = 0; i < common; i++) {
+        if (!sameRecord(expected.retired[i], actual.retired[i])) {
+            report << "first divergent instruction " << expected.retired[i].sequenceNum << " (retired #" << i << ")\n"
+                   << "    expected: " << formatLine(expected.retired[i]) << "\n"
+                   << "    actual:   " << formatLine(actual.retired[i]) << "\n";
+            return report.str();
+        }
+    }
+
+    if (expected.retired.size() != actual.retired.size()) {
+        report << "retired " << actual.retired.size() << " instructions, expected " << expected.retired.size() << "\n";
+    }
+    else if (expected.cycles != actual.cycles || expected.instructions != actual.instructions) {
+        report << "finished with " << actual.instructions << " instructions in " << actual.cycles
+               << " cycles, expected " << expected.instructions << " in " << expected.cycles << "\n";
+    }
+    return report.str();
+}
+
+// Print command-line usage
+static void printUsage(const char* program) {
+    cerr << "Usage: " << program << " [options] [trace_file ...]" << endl
+         << "Checks every engine mode against the reference model on the given traces and on" << endl
+         << "generated chain, parallel, latency-mix and register-pressure traces." << endl
+         << "Options:" << endl
+         << "  --length N    Instructions per generated trace (default " << CHECK_DEFAULT_LENGTH << ", 0 for none)" << endl
+         << "  --threads N   Number of worker threads (default: all cores)" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t length = CHECK_DEFAULT_LENGTH;
+    size_t threads = thread::hardware_concurrency();
+    std::vector<CheckTrace> traces;
+
+    for (int argi = 1; argi < argc; argi++) {
+        if (strcmp(argv[argi], "--length") == 0 && argi + 1 < argc) {
+            length = stoull(argv[++argi]);
+        }
+        else if (strcmp(argv[argi], "--threads") == 0 && argi + 1 < argc) {
+            threads = stoul(argv[++argi]);
+        }
+        else if (strncmp(argv[argi], "--", 2) == 0) {
+            cerr << "Error: Unknown option " << argv[argi] << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        else {
+            try {
+                traces.push_back({argv[argi], loadTraceRecords(argv[argi])});
+            }
+            catch (const exception& e) {
+                cerr << "Error: " << e.what() << endl;
+                return 1;
+            }
+        }
+    }
+
+    if (length != 0) {
+        for (TracePattern pattern : ALL_TRACE_PATTERNS) {
+            traces.push_back({std::string("gen:") + tracePatternName(pattern), generateTrace(pattern, length)});
+        }
+    }
+    if (traces.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // One job per trace, configuration and function-unit pool: the reference run, then every
+    // engine mode
+    size_t configCount = sizeof(CHECK_CONFIGS) / sizeof(CHECK_CONFIGS[0]);
+    size_t poolCount = sizeof(ALL_CHECK_POOLS) / sizeof(ALL_CHECK_POOLS[0]);
+    size_t modeCount = sizeof(ALL_CHECK_MODES) / sizeof(ALL_CHECK_MODES[0]);
+    std::vector<std::string> failures(traces.size() * configCount * poolCount);
+
+    std::vector<FunctionUnitPool> functionUnits;
+    for (CheckPool checkPool : ALL_CHECK_POOLS) {
+        functionUnits.push_back(checkFunctionUnitPool(checkPool));
+    }
+
+    WorkStealingPool pool(threads);
+    pool.run(failures.size(), [&](size_t job) {
+        const CheckTrace& trace = traces[job / (configCount * poolCount)];
+        const size_t* size = CHECK_CONFIGS[job / poolCount % configCount];
+        size_t poolIndex = job % poolCount;
+        ProcessorParameters config;
+        config.robSize = size[0];
+        config.iqSize = size[1];
+        config.width = size[2];
+        config.functionUnits = &functionUnits[poolIndex];
+
+        std::ostringstream report;
+        std::string prefix = trace.name + " " + std::to_string(size[0]) + " " +
+                             std::to_string(size[1]) + " " + std::to_string(size[2]) + " " +
+                             checkPoolName(ALL_CHECK_POOLS[poolIndex]);
+        try {
+            RecordingSink sink;
+            MemoryInstructionSource source(trace.records);
+            ReferenceProcessor reference(config, source, &sink);
+            reference.simulate();
+
+            EngineRun expected;
+            expected.retired.swap(sink.records);
+            expected.instructions = reference.instructionCount();
+            expected.cycles = reference.cycleCount();
+
+            for (CheckMode mode : ALL_CHECK_MODES) {
+                std::string difference = compareRuns(expected, runEngine(trace.records, config, mode, expected.cycles, job));
+                if (!difference.empty()) {
+                    report << "FAIL " << prefix << " [" << checkModeName(mode) << "]: " << difference;
+                }
+            }
+        }
+        catch (const exception& e) {
+            report << "FAIL " << prefix << ": " << e.what() << "\n";
+        }
+        failures[job] = report.str();
+    });
+
+    size_t failed = 0;
+    for (const std::string& failure : failures) {
+        if (!failure.empty()) {
+            cout << failure;
+            failed++;
+        }
+    }
+
+    size_t cases = failures.size() * modeCount;
+    cout << (failed ? "FAILED: " : "PASSED: ") << traces.size() << " traces x " << configCount
+         << " configurations x " << poolCount << " function-unit pools x " << modeCount << " modes ("
+         << cases << " runs)";
+    if (failed) {
+        cout << ", " << failed << " trace/configuration/pool combinations diverged";
+    }
+    cout << endl;
+    return failed ? 1 : 0;
+}
@@ -1,16 +1,240 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <thread>
+#include "function_units.h"
 #include "processor.h"
+#include "pipeline_view.h"
+#include "prefetch_source.h"
+#include "result_cache.h"
+#include "retire_log.h"
+#include "sampling.h"
+
+// Print command-line usage
+static void printUsage(const char* program) {
+    cerr << "Usage: " << program 
+              << " [options] <rob_size> <iq_size> <width> <trace_file>" 
+              << endl
+         << "Options:" << endl
+         << "  --prefetch             Decode the trace on a separate thread (default with 2+ cores)" << endl
+         << "  --no-prefetch          Decode the trace on the simulation thread" << endl
+         << "  --fu-config FILE       Function-unit pool (classes, unit counts, op-type latencies)" << endl
+         << "  --no-skip-idle         Evaluate every cycle instead of jumping over idle stretches" << endl
+         << "  --no-specialize        Use the run-time sized engine even for precompiled configurations" << endl
+         << "  --sample-period N      Estimate IPC from one sample every N instructions" << endl
+         << "  --sample-size N        Measured instructions per sample (default " << DEFAULT_SAMPLE_SIZE << ")" << endl
+         << "  --sample-warmup N      Detailed warmup instructions before each sample (default "
+         << DEFAULT_SAMPLE_WARMUP << ")" << endl
+         << "  --intervals FILE       Estimate IPC from weighted intervals (\"<start> <length> <weight>\" lines)" << endl
+         << "  --checkpoint PREFIX    Save checkpoints as PREFIX.<cycle>" << endl
+         << "  --checkpoint-every N   Save a checkpoint every N cycles" << endl
+         << "  --restore FILE         Resume from a checkpoint" << endl
+         << "  --stop-cycle N         Stop (and checkpoint) once N cycles have been simulated" << endl
+         << "  --retire-log MODE      Per-instruction output: text (default), binary or none" << endl
+         << "  --retire-log-file FILE Write the per-instruction output to FILE (required for binary)" << endl
+         << "  --pipeline-view FILE   Export stage timelines (Konata log, or Chrome trace JSON for *.json)" << endl
+         << "  --view-format F        Pipeline view format: konata or chrome" << endl
+         << "  --view-seq A:B         Capture instructions with sequence numbers A..B (repeatable)" << endl
+         << "  --view-cycles A:B      Capture instructions in flight during cycles A..B (repeatable)" << endl
+         << "  --view-limit N         Keep at most the last N captured instructions (default "
+         << PIPELINE_VIEW_DEFAULT_LIMIT << ")" << endl
+         << "  --cache DIR            Reuse the results of identical trace/configuration runs stored in DIR" << endl
+         << "                         (requires --retire-log none)" << endl;
+}
+
+// Print the command line and processor configuration preceding the results
+static void printConfiguration(char* argv[]) {
+    cout << "# === Simulator Command =========" << endl
+         << "# ./sim "  << argv[1] << " " <<
+            argv[2] << " " << argv[3] << " " <<
+            argv[4] << " " << endl;
+    cout << "# === Processor Configuration ==="     << endl;
+    cout << "# ROB_SIZE  = "        << argv[1]      << endl;
+    cout << "# IQ_SIZE   = "        << argv[2]      << endl;
+    cout << "# WIDTH     = "        << argv[3]      << endl;
+}
+
+// Run a detailed simulation with periodic checkpoints, optionally resuming from one and stopping
+// early. Returns true if the run stopped before the pipeline drained.
+static bool runWithCheckpoints(
+    SimulationEngine& processor,
+    const string& restorePath,
+    const string& checkpointPrefix,
+    uint64_t checkpointInterval,
+    uint64_t stopCycle
+) {
+    if (!restorePath.empty()) {
+        processor.restoreCheckpoint(restorePath);
+    }
+
+    while (true) {
+        // Run to the next checkpoint boundary or the stop cycle, whichever comes first
+        uint64_t target = stopCycle;
+        if (checkpointInterval != 0) {
+            target = min(target, (processor.cycleCount() / checkpointInterval + 1) * checkpointInterval);
+        }
+        if (!processor.runUntilCycle(target)) {
+            return false;
+        }
+
+        // Checkpoints are named by the cycle reached, which is exactly the target
+        if (!checkpointPrefix.empty()) {
+            processor.saveCheckpoint(checkpointPrefix + "." + to_string(processor.cycleCount()));
+        }
+        if (processor.cycleCount() >= stopCycle) {
+            return true;
+        }
+    }
+}
 
 int main(int argc, char* argv[]) {
+    // Parse leading options
+    bool prefetch = thread::hardware_concurrency() > 1;  // Overlap trace decoding when a spare core exists
+    string functionUnitPath;
+    SimulationOptions options;
+    SamplingParameters sampling;
+    string intervalPath;
+    string checkpointPrefix;
+    string restorePath;
+    uint64_t checkpointInterval = 0;
+    uint64_t stopCycle = UINT64_MAX;
+    string retireLogMode = "text";
+    string retireLogPath;
+    string viewPath;
+    string viewFormat;
+    vector<PipelineViewWindow> viewWindows;
+    size_t viewLimit = PIPELINE_VIEW_DEFAULT_LIMIT;
+    string cachePath;
+
+    int argi = 1;
+    while (argi < argc && strncmp(argv[argi], "--", 2) == 0) {
+        if (strcmp(argv[argi], "--prefetch") == 0) {
+            prefetch = true;
+        }
+        else if (strcmp(argv[argi], "--no-prefetch") == 0) {
+            prefetch = false;
+        }
+        else if (strcmp(argv[argi], "--fu-config") == 0 && argi + 1 < argc) {
+            functionUnitPath = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--no-skip-idle") == 0) {
+            options.skipIdleCycles = false;
+        }
+        else if (strcmp(argv[argi], "--no-specialize") == 0) {
+            options.specializeGeometry = false;
+        }
+        else if (strcmp(argv[argi], "--sample-period") == 0 && argi + 1 < argc) {
+            sampling.period = stoull(argv[++argi]);
+        }
+        else if (strcmp(argv[argi], "--sample-size") == 0 && argi + 1 < argc) {
+            sampling.sampleSize = stoull(argv[++argi]);
+        }
+        else if (strcmp(argv[argi], "--sample-warmup") == 0 && argi + 1 < argc) {
+            sampling.warmup = stoull(argv[++argi]);
+        }
+        else if (strcmp(argv[argi], "--intervals") == 0 && argi + 1 < argc) {
+            intervalPath = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--checkpoint") == 0 && argi + 1 < argc) {
+            checkpointPrefix = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--checkpoint-every") == 0 && argi + 1 < argc) {
+            checkpointInterval = stoull(argv[++argi]);
+        }
+        else if (strcmp(argv[argi], "--restore") == 0 && argi + 1 < argc) {
+            restorePath = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--stop-cycle") == 0 && argi + 1 < argc) {
+            stopCycle = stoull(argv[++argi]);
+        }
+        else if (strcmp(argv[argi], "--retire-log") == 0 && argi + 1 < argc) {
+            retireLogMode = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--retire-log-file") == 0 && argi + 1 < argc) {
+            retireLogPath = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--pipeline-view") == 0 && argi + 1 < argc) {
+            viewPath = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--view-format") == 0 && argi + 1 < argc) {
+            viewFormat = argv[++argi];
+        }
+        else if ((strcmp(argv[argi], "--view-seq") == 0 || strcmp(argv[argi], "--view-cycles") == 0) &&
+                 argi + 1 < argc) {
+            bool byCycle = strcmp(argv[argi], "--view-cycles") == 0;
+            try {
+                viewWindows.push_back(parsePipelineViewWindow(argv[++argi], byCycle));
+            }
+            catch (const exception& e) {
+                cerr << "Error: Invalid pipeline view window " << argv[argi] << " (" << e.what() << ")" << endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[argi], "--view-limit") == 0 && argi + 1 < argc) {
+            viewLimit = stoull(argv[++argi]);
+        }
+        else if (strcmp(argv[argi], "--cache") == 0 && argi + 1 < argc) {
+            cachePath = argv[++argi];
+        }
+        else {
+            cerr << "Error: Unknown option " << argv[argi] << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        argi++;
+    }
+
     // Check for correct number of command-line arguments
-    if (argc != 5) {
-        cerr << "Usage: " << argv[0] 
-                  << " <rob_size> <iq_size> <width> <trace_file>" 
-                  << endl;
+    if (argc - argi != 4) {
+        printUsage(argv[0]);
         return 1;
     }
 
+    // Checkpoints capture a full detailed run; sampled runs rebuild their pipeline per sample
+    bool sampled = sampling.period != 0 || !intervalPath.empty();
+    bool checkpointing = checkpointInterval != 0 || !restorePath.empty() || stopCycle != UINT64_MAX;
+    if (sampled && checkpointing) {
+        cerr << "Error: Checkpoint options cannot be combined with sampling" << endl;
+        return 1;
+    }
+    if (checkpointInterval != 0 && checkpointPrefix.empty()) {
+        cerr << "Error: --checkpoint-every requires --checkpoint" << endl;
+        return 1;
+    }
+    if (retireLogMode != "text" && retireLogMode != "binary" && retireLogMode != "none") {
+        cerr << "Error: Unknown retire log mode " << retireLogMode << endl;
+        return 1;
+    }
+    if (retireLogMode == "binary" && retireLogPath.empty()) {
+        cerr << "Error: --retire-log binary requires --retire-log-file" << endl;
+        return 1;
+    }
+    if (viewFormat.empty()) {
+        bool json = viewPath.size() >= 5 && viewPath.compare(viewPath.size() - 5, 5, ".json") == 0;
+        viewFormat = json ? "chrome" : "konata";
+    }
+    if (viewFormat != "konata" && viewFormat != "chrome") {
+        cerr << "Error: Unknown pipeline view format " << viewFormat << endl;
+        return 1;
+    }
+    if (!viewPath.empty() && sampled) {
+        cerr << "Error: --pipeline-view cannot be combined with sampling" << endl;
+        return 1;
+    }
+    if (viewLimit == 0) {
+        cerr << "Error: --view-limit must be at least 1" << endl;
+        return 1;
+    }
+    if (!cachePath.empty() && (retireLogMode != "none" || sampled || checkpointing || !viewPath.empty())) {
+        cerr << "Error: --cache requires --retire-log none and a complete run without sampling," << endl
+             << "       checkpoints or pipeline views" << endl;
+        return 1;
+    }
+    argv += argi - 1;  // Positional arguments are argv[1..4] from here on
+
     // Parse configuration parameters first
     ProcessorParameters config;
     
@@ -18,37 +242,173 @@ int main(int argc, char* argv[]) {
     config.iqSize = stoul(argv[2]);     // IQ size is second argument
     config.width = stoul(argv[3]);      // Width is third argument
 
-    // Open trace file (fourth argument)
-    FILE* traceFile = fopen(argv[4], "r");
-    if (!traceFile) {
+    // Function-unit pool; the default one unless --fu-config names a file
+    FunctionUnitPool functionUnits;
+    if (!functionUnitPath.empty()) {
+        try {
+            functionUnits = loadFunctionUnitPool(functionUnitPath);
+        }
+        catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+        config.functionUnits = &functionUnits;
+    }
+
+    // Result cache: a stored run of the same trace contents and configuration replaces simulating
+    unique_ptr<ResultCache> cache;
+    uint64_t traceHash = 0;
+    if (!cachePath.empty()) {
+        try {
+            cache.reset(new ResultCache(cachePath));
+            traceHash = cache->traceHash(argv[4]);
+            CachedResult cached;
+            if (cache->lookup(traceHash, config, cached)) {
+                printConfiguration(argv);
+                cout << cached.report;
+                return 0;
+            }
+        }
+        catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+
+    // Open trace file (fourth argument); text, binary and compressed traces are detected automatically
+    unique_ptr<InstructionSource> source;
+    try {
+        source = openInstructionSource(argv[4]);
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    if (!source) {
         cerr << "Error: Could not open trace file " << argv[4] << endl;
         return 1;
     }
 
-    // Create processor instance with configuration and trace file
-    OutOfOrderProcessor processor(config, traceFile);
+    // Decode ahead of the fetch stage on a producer thread
+    if (prefetch) {
+        source.reset(new PrefetchInstructionSource(std::move(source)));
+    }
+
+    // Per-instruction output: buffered text (stdout by default) or a binary log written by a
+    // background thread
+    unique_ptr<FILE, int (*)(FILE*)> retireLogFile(nullptr, fclose);
+    unique_ptr<RetireSink> retireLog;
+    try {
+        if (retireLogMode == "binary") {
+            retireLog.reset(new BinaryRetireLog(retireLogPath));
+        }
+        else if (retireLogMode == "text" && !retireLogPath.empty()) {
+            retireLogFile.reset(fopen(retireLogPath.c_str(), "w"));
+            if (!retireLogFile) {
+                throw runtime_error("could not create retire log " + retireLogPath);
+            }
+            retireLog.reset(new TextRetireLog(retireLogFile.get()));
+        }
+        else if (retireLogMode == "text") {
+            retireLog.reset(new TextRetireLog(stdout));
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    options.retireSink = retireLog.get();
+
+    // Pipeline view: capture the requested windows alongside the retire log
+    unique_ptr<PipelineViewCapture> view;
+    unique_ptr<RetireSinkTee> tee;
+    if (!viewPath.empty()) {
+        view.reset(new PipelineViewCapture(viewWindows, viewLimit));
+        if (retireLog) {
+            tee.reset(new RetireSinkTee(*retireLog, *view));
+            options.retireSink = tee.get();
+        }
+        else {
+            options.retireSink = view.get();
+        }
+    }
+
+    // Sampled simulation: estimate IPC from detailed samples, fast-forwarding in between
+    SampledEstimate estimate;
+    unique_ptr<SimulationEngine> processor;
+    bool stopped = false;
 
     try {
-        processor.simulate();
+        if (!intervalPath.empty()) {
+            estimate = runIntervalSampling(*source, config, loadSimulationIntervals(intervalPath),
+                                           sampling.warmup, options);
+        }
+        else if (sampled) {
+            estimate = runSystematicSampling(*source, config, sampling, options);
+        }
+        else {
+            // Throws for configurations the engine cannot be built with (e.g. WIDTH 0)
+            processor = makeProcessor(config, *source, options);
+            if (checkpointing) {
+                stopped = runWithCheckpoints(*processor, restorePath, checkpointPrefix, checkpointInterval, stopCycle);
+            }
+            else {
+                processor->simulate();
+            }
+        }
+
+        // The per-instruction lines precede the summary
+        if (retireLog) {
+            retireLog->flush();
+        }
+        if (view) {
+            view->write(viewPath, viewFormat == "chrome" ? PipelineViewFormat::Chrome : PipelineViewFormat::Konata);
+            if (view->droppedCount()) {
+                cerr << "Pipeline view kept the last " << view->capturedCount() << " of "
+                     << view->capturedCount() + view->droppedCount() << " captured instructions" << endl;
+            }
+        }
     }
     catch (const exception& e) {
         cerr << "Simulation error: " << e.what() << endl;
-        fclose(traceFile);
         return 1;
     }
 
     // Print simulation configuration and results
-    cout << "# === Simulator Command =========" << endl
-         << "# ./sim "  << argv[1] << " " <<
-            argv[2] << " " << argv[3] << " " <<
-            argv[4] << " " << endl;
-    cout << "# === Processor Configuration ==="     << endl;
-    cout << "# ROB_SIZE  = "        << argv[1]      << endl;
-    cout << "# IQ_SIZE   = "        << argv[2]      << endl;
-    cout << "# WIDTH     = "        << argv[3]      << endl;
+    printConfiguration(argv);
 
     // Display final simulation metrics
-    processor.printSimulationResults();
+    if (stopped) {
+        cout << "# Stopped at cycle " << processor->cycleCount() << " after "
+             << processor->retiredCount() << " retired instructions" << endl;
+    }
+    else if (sampled) {
+        printSampledResults(estimate);
+    }
+    else if (cache) {
+        // Capture the summary for the cache (cout keeps its formatting state while redirected)
+        ostringstream report;
+        streambuf* console = cout.rdbuf(report.rdbuf());
+        processor->printSimulationResults();
+        STATS_HOOK(processor->printPipelineStats();)
+        cout.rdbuf(console);
+        cout << report.str();
+
+        CachedResult result;
+        result.instructions = processor->instructionCount();
+        result.cycles = processor->cycleCount();
+        result.report = report.str();
+        try {
+            cache->store(traceHash, config, result);
+        }
+        catch (const exception& e) {
+            cerr << "Warning: " << e.what() << endl;
+        }
+    }
+    else {
+        processor->printSimulationResults();
+        STATS_HOOK(processor->printPipelineStats();)
+    }
 
     return 0;
-}
\ No newline at end of file
+}
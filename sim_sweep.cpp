@@ -0,0 +1,856 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "batch_simulator.h"
+#include "function_units.h"
+#include "interval_estimator.h"
+#include "processor.h"
+#include "work_stealing_pool.h"
+
+// One point of the ROB_SIZE x IQ_SIZE x WIDTH grid and its outcome
+struct SweepResult {
+    ProcessorParameters config;
+    uint64_t instructions;
+    uint64_t cycles;
+    string error;  // Empty when the simulation completed
+
+    SweepResult() : instructions(0), cycles(0) {}
+};
+
+// Print command-line usage
+static void printUsage(const char* program) {
+    cerr << "Usage: " << program
+         << " [options] <rob_sizes> <iq_sizes> <widths> <trace_file>" << endl
+         << "Each size list is comma-separated; an item is a value N or a range LO:HI[:STEP]" << endl
+         << "  (STEP *K multiplies instead of adding), e.g. 32,64,128 or 16:512:*2" << endl
+         << "Options:" << endl
+         << "  --threads N      Number of worker threads (default: all cores)" << endl
+         << "  --format F       Results table format: csv (default) or json" << endl
+         << "  --output FILE    Write the results table to FILE instead of stdout" << endl
+         << "  --batch K        Simulate K configurations per task in lockstep over one streamed" << endl
+         << "                   pass of the trace, instead of decoding the whole trace into memory" << endl
+         << "  --target-ipc X   Search mode: find the smallest ROB/IQ configurations reaching IPC X for" << endl
+         << "                   each width, instead of simulating the whole grid" << endl
+         << "  --target-fraction F" << endl
+         << "                   Search mode with the target F times the IPC of the largest ROB/IQ of each width" << endl
+         << "  --estimate       Estimate every configuration with the analytical interval model in one" << endl
+         << "                   pass of the trace, instead of simulating it" << endl
+         << "  --calibrate      Estimate and simulate every configuration and report the estimation error" << endl
+         << "  --fu-config FILE Function-unit pool (classes, unit counts, op-type latencies)" << endl
+         << "  --no-skip-idle   Evaluate every cycle instead of jumping over idle stretches" << endl
+         << "  --no-specialize  Use the run-time sized engine even for precompiled configurations" << endl;
+}
+
+// Parse a size list such as "32,64" or "16:512:*2"
+static vector<size_t> parseSizeList(const string& text) {
+    vector<size_t> values;
+    stringstream items(text);
+    string item;
+    while (getline(items, item, ',')) {
+        size_t first = item.find(':');
+        if (first == string::npos) {
+            values.push_back(stoul(item));
+            continue;
+        }
+
+        size_t second = item.find(':', first + 1);
+        size_t low = stoul(item.substr(0, first));
+        size_t high = stoul(item.substr(first + 1, second == string::npos ? string::npos : second - first - 1));
+        string step = second == string::npos ? "1" : item.substr(second + 1);
+
+        bool geometric = !step.empty() && step[0] == '*';
+        size_t amount = stoul(geometric ? step.substr(1) : step);
+        if (low == 0 || amount < (geometric ? 2u : 1u)) {
+            throw invalid_argument("bad range " + item);
+        }
+        for (size_t value = low; value <= high; value = geometric ? value * amount : value + amount) {
+            values.push_back(value);
+        }
+    }
+
+    if (values.empty()) {
+        throw invalid_argument("empty size list");
+    }
+    return values;
+}
+
+// Quote a string for a CSV field
+static string csvField(const string& text) {
+    if (text.find_first_of(",\"\n") == string::npos) {
+        return text;
+    }
+
+    string quoted = "\"";
+    for (char c : text) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// Quote a string for a JSON value
+static string jsonString(const string& text) {
+    string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// Write the results table, one row per configuration in grid order
+static void writeResults(ostream& out, const vector<SweepResult>& results, bool json) {
+    if (json) {
+        out << "[" << endl;
+    }
+    else {
+        out << "rob_size,iq_size,width,instructions,cycles,ipc,error" << endl;
+    }
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const SweepResult& result = results[i];
+        double ipc = result.cycles ? static_cast<double>(result.instructions) / result.cycles : 0.0;
+
+        if (json) {
+            out << "  {\"rob_size\": " << result.config.robSize
+                << ", \"iq_size\": " << result.config.iqSize
+                << ", \"width\": " << result.config.width
+                << ", \"instructions\": " << result.instructions
+                << ", \"cycles\": " << result.cycles
+                << ", \"ipc\": " << fixed << setprecision(4) << ipc
+                << ", \"error\": " << (result.error.empty() ? "null" : jsonString(result.error))
+                << "}" << (i + 1 < results.size() ? "," : "") << endl;
+        }
+        else {
+            out << result.config.robSize << ","
+                << result.config.iqSize << ","
+                << result.config.width << ","
+                << result.instructions << ","
+                << result.cycles << ","
+                << fixed << setprecision(4) << ipc << ","
+                << csvField(result.error) << endl;
+        }
+    }
+
+    if (json) {
+        out << "]" << endl;
+    }
+}
+
+// Search Mode
+// IPC never decreases as ROB_SIZE or IQ_SIZE grows, so for one WIDTH the configurations reaching
+// a target form a staircase: walking ROB sizes upward, the smallest sufficient IQ size can only
+// shrink. The walk tests O(|ROB sizes| + |IQ sizes|) configurations instead of all of them, and a
+// run stops as soon as its cycle count rules the target out.
+
+// Outcome of searching one WIDTH
+struct SearchResult {
+    size_t width;
+    double targetIpc;
+    vector<SweepResult> frontier;  // Minimal configurations reaching the target, by ascending ROB_SIZE
+    size_t simulations;            // Configurations simulated
+    size_t stoppedEarly;           // Simulations abandoned once the target was out of reach
+    string error;                  // Why the search failed; empty otherwise
+
+    SearchResult() : width(0), targetIpc(0.0), simulations(0), stoppedEarly(0) {}
+};
+
+// Most cycles a run of count instructions may take and still reach targetIpc
+static uint64_t cycleBudget(uint64_t count, double targetIpc) {
+    uint64_t budget = static_cast<uint64_t>(floor(count / targetIpc));
+    while (static_cast<double>(count) / (budget + 1) >= targetIpc) {
+        budget++;
+    }
+    while (budget > 0 && static_cast<double>(count) / budget < targetIpc) {
+        budget--;
+    }
+    return budget;
+}
+
+// Simulate one configuration against the target (0: no target, run to completion). Returns true
+// if it finished at the target IPC or better, with its counts in result.
+static bool reachesTarget(const vector<TraceRecord>& trace, const SimulationOptions& options,
+                          double targetIpc, SweepResult& result, SearchResult& search) {
+    search.simulations++;
+    try {
+        MemoryInstructionSource source(trace);
+        unique_ptr<SimulationEngine> processor = makeProcessor(result.config, source, options);
+        if (targetIpc > 0.0) {
+            uint64_t budget = cycleBudget(trace.size(), targetIpc);
+            processor->runUntilCycle(budget + 1);
+            if (!processor->isFinished() || processor->cycleCount() > budget) {
+                search.stoppedEarly++;
+                return false;
+            }
+        }
+        else {
+            processor->simulate();
+        }
+        result.instructions = processor->instructionCount();
+        result.cycles = processor->cycleCount();
+        return true;
+    }
+    catch (const exception& e) {
+        result.error = e.what();  // Deadlocked configurations never reach a target
+        return false;
+    }
+}
+
+// Staircase walk over the sorted ROB and IQ sizes of one width
+static void searchWidth(const vector<TraceRecord>& trace, const SimulationOptions& options,
+                        const FunctionUnitPool* functionUnits, const vector<size_t>& robSizes,
+                        const vector<size_t>& iqSizes, double targetIpc, double targetFraction,
+                        SearchResult& search) {
+    auto point = [&](size_t robSize, size_t iqSize) {
+        SweepResult result;
+        result.config.functionUnits = functionUnits;
+        result.config.robSize = robSize;
+        result.config.iqSize = iqSize;
+        result.config.width = search.width;
+        return result;
+    };
+
+    // A relative target is measured against the largest configuration
+    search.targetIpc = targetIpc;
+    if (targetFraction > 0.0) {
+        SweepResult peak = point(robSizes.back(), iqSizes.back());
+        if (!reachesTarget(trace, options, 0.0, peak, search)) {
+            search.error = "largest configuration failed: " + peak.error;
+            return;
+        }
+        search.targetIpc = targetFraction * peak.instructions / peak.cycles;
+    }
+
+    size_t iqIndex = iqSizes.size() - 1;
+    bool reached = false;  // Some smaller ROB already reached the target at iqSizes[iqIndex]
+    for (size_t robSize : robSizes) {
+        SweepResult best = point(robSize, iqSizes[iqIndex]);
+        bool improved = false;
+        if (!reached) {
+            if (!reachesTarget(trace, options, search.targetIpc, best, search)) {
+                continue;
+            }
+            reached = true;
+            improved = true;
+        }
+
+        // Shrink the IQ while this ROB still reaches the target
+        while (iqIndex > 0) {
+            SweepResult smaller = point(robSize, iqSizes[iqIndex - 1]);
+            if (!reachesTarget(trace, options, search.targetIpc, smaller, search)) {
+                break;
+            }
+            best = smaller;
+            iqIndex--;
+            improved = true;
+        }
+
+        // A larger ROB at the same IQ is dominated by the previous frontier point
+        if (improved) {
+            search.frontier.push_back(best);
+        }
+    }
+
+    if (search.frontier.empty()) {
+        search.error = "target IPC not reached";
+    }
+}
+
+// Write the frontiers, one row per minimal configuration (or one error row per width)
+static void writeSearchResults(ostream& out, const vector<SearchResult>& searches, bool json) {
+    if (json) {
+        out << "[" << endl;
+    }
+    else {
+        out << "width,target_ipc,rob_size,iq_size,instructions,cycles,ipc,simulations,stopped_early,error" << endl;
+    }
+
+    for (size_t i = 0; i < searches.size(); i++) {
+        const SearchResult& search = searches[i];
+        if (json) {
+            out << "  {\"width\": " << search.width
+                << ", \"target_ipc\": " << fixed << setprecision(4) << search.targetIpc
+                << ", \"simulations\": " << search.simulations
+                << ", \"stopped_early\": " << search.stoppedEarly
+                << ", \"error\": " << (search.error.empty() ? "null" : jsonString(search.error))
+                << ", \"frontier\": [";
+            for (size_t j = 0; j < search.frontier.size(); j++) {
+                const SweepResult& result = search.frontier[j];
+                out << (j ? ", " : "")
+                    << "{\"rob_size\": " << result.config.robSize
+                    << ", \"iq_size\": " << result.config.iqSize
+                    << ", \"instructions\": " << result.instructions
+                    << ", \"cycles\": " << result.cycles
+                    << ", \"ipc\": " << static_cast<double>(result.instructions) / result.cycles << "}";
+            }
+            out << "]}" << (i + 1 < searches.size() ? "," : "") << endl;
+            continue;
+        }
+
+        if (search.frontier.empty()) {
+            out << search.width << "," << fixed << setprecision(4) << search.targetIpc << ",,,,,,"
+                << search.simulations << "," << search.stoppedEarly << "," << csvField(search.error) << endl;
+        }
+        for (const SweepResult& result : search.frontier) {
+            out << search.width << ","
+                << fixed << setprecision(4) << search.targetIpc << ","
+                << result.config.robSize << ","
+                << result.config.iqSize << ","
+                << result.instructions << ","
+                << result.cycles << ","
+                << static_cast<double>(result.instructions) / result.cycles << ","
+                << search.simulations << ","
+                << search.stoppedEarly << "," << endl;
+        }
+    }
+
+    if (json) {
+        out << "]" << endl;
+    }
+}
+
+// Search every width in parallel and write the frontiers; returns the exit status
+static int runSearch(WorkStealingPool& pool, const char* tracePath, vector<size_t> robSizes,
+                     vector<size_t> iqSizes, const vector<size_t>& widths, double targetIpc,
+                     double targetFraction, const SimulationOptions& options,
+                     const FunctionUnitPool* functionUnits, bool json, const string& outputPath) {
+    vector<TraceRecord> trace;
+    try {
+        trace = loadTraceRecords(tracePath);
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    if (trace.empty()) {
+        cerr << "Error: Empty trace " << tracePath << endl;
+        return 1;
+    }
+
+    sort(robSizes.begin(), robSizes.end());
+    robSizes.erase(unique(robSizes.begin(), robSizes.end()), robSizes.end());
+    sort(iqSizes.begin(), iqSizes.end());
+    iqSizes.erase(unique(iqSizes.begin(), iqSizes.end()), iqSizes.end());
+
+    vector<SearchResult> searches(widths.size());
+    pool.run(widths.size(), [&](size_t index) {
+        searches[index].width = widths[index];
+        searchWidth(trace, options, functionUnits, robSizes, iqSizes, targetIpc, targetFraction, searches[index]);
+    });
+
+    if (outputPath.empty()) {
+        writeSearchResults(cout, searches, json);
+    }
+    else {
+        ofstream output(outputPath);
+        writeSearchResults(output, searches, json);
+        if (!output) {
+            cerr << "Error: Could not write results to " << outputPath << endl;
+            return 1;
+        }
+    }
+
+    size_t simulations = 0;
+    size_t stoppedEarly = 0;
+    for (const SearchResult& search : searches) {
+        simulations += search.simulations;
+        stoppedEarly += search.stoppedEarly;
+    }
+    cerr << "Searched " << widths.size() << " widths with " << simulations << " simulations ("
+         << stoppedEarly << " stopped early) of " << widths.size() * robSizes.size() * iqSizes.size()
+         << " grid points" << endl;
+    return 0;
+}
+
+// Estimate Mode
+// The interval model replaces simulation: one pass over the trace builds the window profile,
+// from which every configuration of the grid is estimated in constant time.
+
+// Profile the trace for windows up to the largest ROB of the grid; throws if it cannot be read
+static unique_ptr<IntervalEstimator> profileTrace(const char* tracePath, const vector<SweepResult>& results) {
+    uint32_t maxWindow = 1;
+    for (const SweepResult& result : results) {
+        maxWindow = max(maxWindow, result.config.robSize);
+    }
+
+    unique_ptr<InstructionSource> source = openInstructionSource(tracePath);
+    if (!source) {
+        throw runtime_error(string("could not open trace file ") + tracePath);
+    }
+    unique_ptr<IntervalEstimator> estimator(new IntervalEstimator(maxWindow, results.front().config.functionUnits));
+    estimator->addAll(*source);
+    return estimator;
+}
+
+// Fill in the estimated counts of every configuration
+static void estimateResults(const IntervalEstimator& estimator, const IntervalModelParameters& model,
+                            vector<SweepResult>& results) {
+    for (SweepResult& result : results) {
+        try {
+            result.instructions = estimator.instructionCount();
+            result.cycles = estimator.cycleCount(result.config, model);
+        }
+        catch (const exception& e) {
+            result.instructions = 0;
+            result.error = e.what();
+        }
+    }
+}
+
+// Simulate every configuration over the in-memory trace
+static void simulateResults(WorkStealingPool& pool, const vector<TraceRecord>& trace,
+                            const SimulationOptions& options, vector<SweepResult>& results) {
+    pool.run(results.size(), [&](size_t index) {
+        SweepResult& result = results[index];
+        try {
+            MemoryInstructionSource source(trace);
+            unique_ptr<SimulationEngine> processor = makeProcessor(result.config, source, options);
+            processor->simulate();
+            result.instructions = processor->instructionCount();
+            result.cycles = processor->cycleCount();
+        }
+        catch (const exception& e) {
+            result.error = e.what();
+        }
+    });
+}
+
+// IPC of a result (0 when it has no cycles)
+static double resultIpc(const SweepResult& result) {
+    return result.cycles ? static_cast<double>(result.instructions) / result.cycles : 0.0;
+}
+
+// Mean absolute relative IPC error of the estimates against the configurations simulated without error
+static double meanEstimateError(const IntervalEstimator& estimator, const IntervalModelParameters& model,
+                                const vector<SweepResult>& simulated) {
+    double total = 0.0;
+    size_t compared = 0;
+    for (const SweepResult& result : simulated) {
+        if (result.error.empty() && result.cycles) {
+            total += fabs(estimator.ipc(result.config, model) / resultIpc(result) - 1.0);
+            compared++;
+        }
+    }
+    return compared ? total / compared : 0.0;
+}
+
+// Fit the model constants to the simulated configurations: coordinate descent from the built-in
+// values, halving the step of each constant until no step improves the mean error
+static IntervalModelParameters refitModel(const IntervalEstimator& estimator, const vector<SweepResult>& simulated,
+                                          double& error) {
+    IntervalModelParameters model;
+    double* constants[] = {&model.iqScale, &model.iqWidthSlack, &model.widthDiscount, &model.blend};
+    double steps[] = {0.5, 0.25, 0.25, 1.0};
+    double floors[] = {0.0, 0.0, 0.0, 1.0};
+    error = meanEstimateError(estimator, model, simulated);
+
+    for (int round = 0; round < 8; round++) {
+        for (size_t i = 0; i < 4; i++) {
+            bool improved = true;
+            while (improved) {
+                improved = false;
+                for (double direction : {1.0, -1.0}) {
+                    double original = *constants[i];
+                    *constants[i] = max(floors[i], original + direction * steps[i]);
+                    double trial = meanEstimateError(estimator, model, simulated);
+                    if (trial < error - 1e-9) {
+                        error = trial;
+                        improved = true;
+                        break;
+                    }
+                    *constants[i] = original;
+                }
+            }
+            steps[i] /= 2;
+        }
+    }
+    return model;
+}
+
+// Write the calibration table, one row per configuration comparing the estimate with the
+// detailed simulation, followed (for CSV, as comment lines) by the error summary and the
+// constants refitted to this grid
+static void writeCalibration(ostream& out, const vector<SweepResult>& estimates,
+                             const vector<SweepResult>& simulated, const IntervalModelParameters& refit,
+                             double refitError, double estimateSeconds, double simulateSeconds, bool json) {
+    // Error statistics over the configurations both models completed
+    double totalError = 0.0;
+    double worstError = 0.0;
+    size_t worst = 0;
+    size_t compared = 0;
+    size_t ordered = 0;     // Pairs of configurations the estimate ranks like the simulation
+    size_t pairs = 0;
+    for (size_t i = 0; i < estimates.size(); i++) {
+        if (!estimates[i].error.empty() || !simulated[i].error.empty()) {
+            continue;
+        }
+        double error = fabs(resultIpc(estimates[i]) / resultIpc(simulated[i]) - 1.0);
+        totalError += error;
+        compared++;
+        if (error >= worstError) {
+            worstError = error;
+            worst = i;
+        }
+        for (size_t j = 0; j < i; j++) {
+            if (!estimates[j].error.empty() || !simulated[j].error.empty() ||
+                resultIpc(simulated[i]) == resultIpc(simulated[j])) {
+                continue;
+            }
+            pairs++;
+            ordered += (resultIpc(estimates[i]) > resultIpc(estimates[j])) ==
+                       (resultIpc(simulated[i]) > resultIpc(simulated[j]));
+        }
+    }
+    double meanError = compared ? totalError / compared : 0.0;
+    double rankAgreement = pairs ? static_cast<double>(ordered) / pairs : 1.0;
+    double speedup = estimateSeconds > 0.0 ? simulateSeconds / estimateSeconds : 0.0;
+
+    if (json) {
+        out << "{\"configurations\": " << compared
+            << ", \"mean_abs_error_pct\": " << fixed << setprecision(2) << 100.0 * meanError
+            << ", \"max_abs_error_pct\": " << 100.0 * worstError
+            << ", \"rank_agreement\": " << setprecision(4) << rankAgreement
+            << ", \"estimate_seconds\": " << setprecision(6) << estimateSeconds
+            << ", \"simulate_seconds\": " << simulateSeconds
+            << ", \"speedup\": " << setprecision(1) << speedup
+            << ", \"refit\": {\"iq_scale\": " << setprecision(4) << refit.iqScale
+            << ", \"iq_width_slack\": " << refit.iqWidthSlack
+            << ", \"width_discount\": " << refit.widthDiscount
+            << ", \"blend\": " << refit.blend
+            << ", \"mean_abs_error_pct\": " << setprecision(2) << 100.0 * refitError << "}"
+            << ", \"results\": [" << endl;
+    }
+    else {
+        out << "rob_size,iq_size,width,instructions,estimated_cycles,estimated_ipc,cycles,ipc,error_pct,error" << endl;
+    }
+
+    for (size_t i = 0; i < estimates.size(); i++) {
+        const SweepResult& estimate = estimates[i];
+        const SweepResult& result = simulated[i];
+        string error = !result.error.empty() ? result.error : estimate.error;
+        bool valid = estimate.error.empty() && result.error.empty();
+        double errorPct = valid ? 100.0 * (resultIpc(estimate) / resultIpc(result) - 1.0) : 0.0;
+
+        if (json) {
+            out << "  {\"rob_size\": " << result.config.robSize
+                << ", \"iq_size\": " << result.config.iqSize
+                << ", \"width\": " << result.config.width
+                << ", \"instructions\": " << result.instructions
+                << ", \"estimated_cycles\": " << estimate.cycles
+                << ", \"estimated_ipc\": " << fixed << setprecision(4) << resultIpc(estimate)
+                << ", \"cycles\": " << result.cycles
+                << ", \"ipc\": " << resultIpc(result)
+                << ", \"error_pct\": " << setprecision(2) << errorPct
+                << ", \"error\": " << (error.empty() ? "null" : jsonString(error))
+                << "}" << (i + 1 < estimates.size() ? "," : "") << endl;
+        }
+        else {
+            out << result.config.robSize << ","
+                << result.config.iqSize << ","
+                << result.config.width << ","
+                << result.instructions << ","
+                << estimate.cycles << ","
+                << fixed << setprecision(4) << resultIpc(estimate) << ","
+                << result.cycles << ","
+                << resultIpc(result) << ","
+                << setprecision(2) << errorPct << ","
+                << csvField(error) << endl;
+        }
+    }
+
+    if (json) {
+        out << "]}" << endl;
+        return;
+    }
+    out << "# configurations compared: " << compared << endl
+        << "# mean absolute IPC error: " << fixed << setprecision(2) << 100.0 * meanError << "%" << endl;
+    if (compared) {
+        out << "# max absolute IPC error: " << 100.0 * worstError << "% (ROB " << simulated[worst].config.robSize
+            << ", IQ " << simulated[worst].config.iqSize << ", WIDTH " << simulated[worst].config.width << ")" << endl;
+    }
+    out << "# pairwise rank agreement: " << setprecision(4) << rankAgreement << endl
+        << "# estimate time: " << setprecision(6) << estimateSeconds << " s, simulation time: "
+        << simulateSeconds << " s (" << setprecision(1) << speedup << "x)" << endl
+        << "# refit constants: iqScale " << setprecision(4) << refit.iqScale
+        << ", iqWidthSlack " << refit.iqWidthSlack << ", widthDiscount " << refit.widthDiscount
+        << ", blend " << refit.blend << " (mean absolute IPC error " << setprecision(2)
+        << 100.0 * refitError << "%)" << endl;
+}
+
+// Estimate and simulate the grid and write the calibration report; returns the exit status
+static int runCalibration(WorkStealingPool& pool, const char* tracePath, vector<SweepResult>& results,
+                          const SimulationOptions& options, bool json, const string& outputPath) {
+    vector<SweepResult> estimates = results;
+    unique_ptr<IntervalEstimator> estimator;
+    vector<TraceRecord> trace;
+    double estimateSeconds, simulateSeconds;
+    try {
+        auto start = chrono::steady_clock::now();
+        estimator = profileTrace(tracePath, results);
+        estimateResults(*estimator, IntervalModelParameters(), estimates);
+        estimateSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // Simulation time includes decoding the trace, as the estimate's includes reading it
+        start = chrono::steady_clock::now();
+        trace = loadTraceRecords(tracePath);
+        simulateResults(pool, trace, options, results);
+        simulateSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    double refitError;
+    IntervalModelParameters refit = refitModel(*estimator, results, refitError);
+
+    if (outputPath.empty()) {
+        writeCalibration(cout, estimates, results, refit, refitError, estimateSeconds, simulateSeconds, json);
+    }
+    else {
+        ofstream output(outputPath);
+        writeCalibration(output, estimates, results, refit, refitError, estimateSeconds, simulateSeconds, json);
+        if (!output) {
+            cerr << "Error: Could not write results to " << outputPath << endl;
+            return 1;
+        }
+    }
+
+    cerr << "Calibrated " << results.size() << " configurations on "
+         << min(pool.threadCount(), results.size()) << " threads" << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Parse leading options
+    size_t threads = thread::hardware_concurrency();
+    bool json = false;
+    string outputPath;
+    size_t batchSize = 0;  // 0: one task per configuration over the in-memory trace
+    double targetIpc = 0.0;       // Search mode with an absolute target when positive
+    double targetFraction = 0.0;  // Search mode with a target relative to the largest configuration
+    bool estimate = false;        // Interval-model estimates instead of simulations
+    bool calibrate = false;       // Estimates compared with simulations
+    string functionUnitPath;
+    SimulationOptions options;  // No per-instruction output
+
+    int argi = 1;
+    while (argi < argc && strncmp(argv[argi], "--", 2) == 0) {
+        if (strcmp(argv[argi], "--threads") == 0 && argi + 1 < argc) {
+            threads = stoul(argv[++argi]);
+        }
+        else if (strcmp(argv[argi], "--format") == 0 && argi + 1 < argc) {
+            string format = argv[++argi];
+            if (format != "csv" && format != "json") {
+                cerr << "Error: Unknown format " << format << endl;
+                return 1;
+            }
+            json = format == "json";
+        }
+        else if (strcmp(argv[argi], "--output") == 0 && argi + 1 < argc) {
+            outputPath = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--batch") == 0 && argi + 1 < argc) {
+            batchSize = stoul(argv[++argi]);
+            if (batchSize == 0) {
+                cerr << "Error: Batch size must be at least 1" << endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[argi], "--target-ipc") == 0 && argi + 1 < argc) {
+            targetIpc = stod(argv[++argi]);
+            if (!(targetIpc > 0.0)) {
+                cerr << "Error: Target IPC must be positive" << endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[argi], "--target-fraction") == 0 && argi + 1 < argc) {
+            targetFraction = stod(argv[++argi]);
+            if (!(targetFraction > 0.0 && targetFraction <= 1.0)) {
+                cerr << "Error: Target fraction must be in (0, 1]" << endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[argi], "--estimate") == 0) {
+            estimate = true;
+        }
+        else if (strcmp(argv[argi], "--calibrate") == 0) {
+            calibrate = true;
+        }
+        else if (strcmp(argv[argi], "--fu-config") == 0 && argi + 1 < argc) {
+            functionUnitPath = argv[++argi];
+        }
+        else if (strcmp(argv[argi], "--no-skip-idle") == 0) {
+            options.skipIdleCycles = false;
+        }
+        else if (strcmp(argv[argi], "--no-specialize") == 0) {
+            options.specializeGeometry = false;
+        }
+        else {
+            cerr << "Error: Unknown option " << argv[argi] << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        argi++;
+    }
+
+    // Check for correct number of command-line arguments
+    if (argc - argi != 4) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    bool search = targetIpc > 0.0 || targetFraction > 0.0;
+    if (targetIpc > 0.0 && targetFraction > 0.0) {
+        cerr << "Error: --target-ipc and --target-fraction are mutually exclusive" << endl;
+        return 1;
+    }
+    if (search && batchSize != 0) {
+        cerr << "Error: --batch cannot be combined with search mode" << endl;
+        return 1;
+    }
+    if ((estimate || calibrate) && (search || batchSize != 0 || (estimate && calibrate))) {
+        cerr << "Error: --estimate and --calibrate cannot be combined with each other, --batch or search mode" << endl;
+        return 1;
+    }
+    argv += argi - 1;  // Positional arguments are argv[1..4] from here on
+
+    // Function-unit pool shared by every configuration; the default one unless --fu-config names a file
+    FunctionUnitPool functionUnits;
+    ProcessorParameters config;
+    if (!functionUnitPath.empty()) {
+        try {
+            functionUnits = loadFunctionUnitPool(functionUnitPath);
+        }
+        catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+        config.functionUnits = &functionUnits;
+    }
+
+    // Expand the configuration grid
+    vector<SweepResult> results;
+    vector<size_t> robSizes;
+    vector<size_t> iqSizes;
+    vector<size_t> widths;
+    try {
+        robSizes = parseSizeList(argv[1]);
+        iqSizes = parseSizeList(argv[2]);
+        widths = parseSizeList(argv[3]);
+
+        for (size_t robSize : robSizes) {
+            for (size_t iqSize : iqSizes) {
+                for (size_t width : widths) {
+                    SweepResult result;
+                    result.config = config;
+                    result.config.robSize = robSize;
+                    result.config.iqSize = iqSize;
+                    result.config.width = width;
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Error: Invalid size list (" << e.what() << ")" << endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    WorkStealingPool pool(threads);
+    size_t tasks = results.size();
+    if (search) {
+        return runSearch(pool, argv[4], robSizes, iqSizes, widths, targetIpc, targetFraction, options,
+                         config.functionUnits, json, outputPath);
+    }
+    if (calibrate) {
+        return runCalibration(pool, argv[4], results, options, json, outputPath);
+    }
+    if (estimate) {
+        try {
+            unique_ptr<IntervalEstimator> estimator = profileTrace(argv[4], results);
+            estimateResults(*estimator, IntervalModelParameters(), results);
+        }
+        catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+    else if (batchSize == 0) {
+        // Decode the trace once; every configuration replays the same read-only records
+        vector<TraceRecord> trace;
+        try {
+            trace = loadTraceRecords(argv[4]);
+        }
+        catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+
+        // Simulate each configuration on its own processor instance
+        simulateResults(pool, trace, options, results);
+    }
+    else {
+        // Each task streams the trace once for a batch of consecutive grid points
+        tasks = (results.size() + batchSize - 1) / batchSize;
+        pool.run(tasks, [&](size_t task) {
+            size_t first = task * batchSize;
+            size_t last = min(first + batchSize, results.size());
+            try {
+                unique_ptr<InstructionSource> source = openInstructionSource(argv[4]);
+                if (!source) {
+                    throw runtime_error(string("could not open trace file ") + argv[4]);
+                }
+                BatchSimulator batch(*source, options);
+                for (size_t index = first; index < last; index++) {
+                    batch.addConfiguration(results[index].config);
+                }
+                batch.simulate();
+                for (size_t index = first; index < last; index++) {
+                    results[index].instructions = batch.instructionCount(index - first);
+                    results[index].cycles = batch.cycleCount(index - first);
+                    results[index].error = batch.error(index - first);
+                }
+            }
+            catch (const exception& e) {
+                for (size_t index = first; index < last; index++) {
+                    results[index].error = e.what();
+                }
+            }
+        });
+    }
+
+    // Write the results table
+    if (outputPath.empty()) {
+        writeResults(cout, results, json);
+    }
+    else {
+        ofstream output(outputPath);
+        writeResults(output, results, json);
+        if (!output) {
+            cerr << "Error: Could not write results to " << outputPath << endl;
+            return 1;
+        }
+    }
+
+    if (estimate) {
+        cerr << "Estimated " << results.size() << " configurations from one pass of the trace" << endl;
+    }
+    else {
+        cerr << "Simulated " << results.size() << " configurations on "
+             << min(pool.threadCount(), tasks) << " threads" << endl;
+    }
+    return 0;
+}
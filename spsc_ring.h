@@ -0,0 +1,77 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// SpscRing: Bounded lock-free ring buffer for exactly one producer thread and one consumer thread.
+// Each side caches the other side's index so the shared atomics are only re-read when the
+// ring looks full (producer) or empty (consumer).
+template <typename T>
+class SpscRing {
+private:
+    std::vector<T> m_slots;   // Ring storage (power-of-two size)
+    size_t m_mask;            // Index mask for wrap-around
+
+    // Consumer-owned state
+    alignas(64) std::atomic<size_t> m_head;  // Next slot to pop
+    size_t m_cachedTail;                     // Consumer's last view of m_tail
+
+    // Producer-owned state
+    alignas(64) std::atomic<size_t> m_tail;  // Next slot to push
+    size_t m_cachedHead;                     // Producer's last view of m_head
+
+    static size_t roundUpToPowerOfTwo(size_t value) {
+        size_t size = 1;
+        while (size < value) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+public:
+    explicit SpscRing(size_t capacity) :
+        m_slots(roundUpToPowerOfTwo(capacity)),
+        m_mask(m_slots.size() - 1),
+        m_head(0),
+        m_cachedTail(0),
+        m_tail(0),
+        m_cachedHead(0)
+    {}
+
+    // Producer: Append an element; returns false if the ring is full
+    bool tryPush(const T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == m_slots.size()) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == m_slots.size()) {
+                return false;
+            }
+        }
+
+        m_slots[tail & m_mask] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: Remove the oldest element; returns false if the ring is empty
+    bool tryPop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return false;
+            }
+        }
+
+        value = m_slots[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Number of slots in the ring
+    size_t capacity() const { return m_slots.size(); }
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "instruction_source.h"
+
+using namespace std;
+
+// Convert a trace (text, binary or compressed) into the fixed-width binary trace format
+int main(int argc, char* argv[]) {
+    // Check for correct number of command-line arguments
+    if (argc != 3) {
+        cerr << "Usage: " << argv[0] << " <trace_file> <binary_trace_file>" << endl;
+        return 1;
+    }
+
+    unique_ptr<InstructionSource> source;
+    try {
+        source = openInstructionSource(argv[1]);
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    if (!source) {
+        cerr << "Error: Could not open trace file " << argv[1] << endl;
+        return 1;
+    }
+
+    // Write next to the output and rename into place only once the whole trace converted
+    string binaryPath = argv[2];
+    string temporaryPath = binaryPath + ".tmp";
+    FILE* binaryFile = fopen(temporaryPath.c_str(), "wb");
+    if (!binaryFile) {
+        cerr << "Error: Could not create binary trace " << binaryPath << endl;
+        return 1;
+    }
+
+    // Write a provisional header; the record count is patched in once known
+    BinaryTraceHeader header;
+    memcpy(header.magic, BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_SIZE);
+    header.version = BINARY_TRACE_VERSION;
+    header.recordSize = sizeof(BinaryTraceRecord);
+    header.recordCount = 0;
+    fwrite(&header, sizeof(header), 1, binaryFile);
+
+    try {
+        TraceRecord record;
+        while (source->next(record)) {
+            // Registers and operation types must fit the packed 8-bit fields
+            if (record.opType < -128 || record.opType > 127 ||
+                record.destReg < -128 || record.destReg > 127 ||
+                record.src1Reg < -128 || record.src1Reg > 127 ||
+                record.src2Reg < -128 || record.src2Reg > 127) {
+                throw runtime_error("record " + to_string(header.recordCount) +
+                                    " does not fit the binary trace format");
+            }
+
+            BinaryTraceRecord packed;
+            packed.pc = record.pc;
+            packed.opType = record.opType;
+            packed.destReg = record.destReg;
+            packed.src1Reg = record.src1Reg;
+            packed.src2Reg = record.src2Reg;
+            fwrite(&packed, sizeof(packed), 1, binaryFile);
+            header.recordCount++;
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        fclose(binaryFile);
+        remove(temporaryPath.c_str());
+        return 1;
+    }
+
+    // Patch the final record count into the header
+    fseek(binaryFile, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, binaryFile);
+    bool failed = ferror(binaryFile) != 0;
+    failed = fclose(binaryFile) != 0 || failed;
+    if (failed || rename(temporaryPath.c_str(), binaryPath.c_str()) != 0) {
+        cerr << "Error: Failed writing binary trace " << binaryPath << endl;
+        remove(temporaryPath.c_str());
+        return 1;
+    }
+
+    cout << "Converted " << header.recordCount << " instructions" << endl;
+    return 0;
+}
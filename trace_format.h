@@ -0,0 +1,50 @@
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+#include <cstdint>
+
+// Binary Trace Format
+// A fixed-width alternative to the text trace format. The file starts with a
+// BinaryTraceHeader followed by recordCount packed BinaryTraceRecord entries.
+// All fields are stored in native (little-endian) byte order.
+
+// Magic bytes identifying a binary trace file
+#define BINARY_TRACE_MAGIC "OOOTRACE"
+#define BINARY_TRACE_MAGIC_SIZE 8
+#define BINARY_TRACE_VERSION 1
+
+// Trace Record
+// Decoded form of one trace line: <PC> <operation_type> <dest_reg> <src1_reg> <src2_reg>
+struct TraceRecord {
+    uint64_t pc;     // Program Counter
+    int opType;      // Operation Type (0, 1 or 2)
+    int destReg;     // Destination register (-1 if none)
+    int src1Reg;     // First source register (-1 if none)
+    int src2Reg;     // Second source register (-1 if none)
+};
+
+// Binary Trace Header
+// Stored once at the beginning of a binary trace file
+struct BinaryTraceHeader {
+    char magic[BINARY_TRACE_MAGIC_SIZE];  // Must equal BINARY_TRACE_MAGIC
+    uint32_t version;                     // Format version (BINARY_TRACE_VERSION)
+    uint32_t recordSize;                  // Size of one packed record in bytes
+    uint64_t recordCount;                 // Number of records following the header
+};
+
+// Binary Trace Record
+// Packed on-disk representation of a TraceRecord (12 bytes)
+#pragma pack(push, 1)
+struct BinaryTraceRecord {
+    uint64_t pc;        // Program Counter
+    int8_t opType;      // Operation Type
+    int8_t destReg;     // Destination register (-1 if none)
+    int8_t src1Reg;     // First source register (-1 if none)
+    int8_t src2Reg;     // Second source register (-1 if none)
+};
+#pragma pack(pop)
+
+static_assert(sizeof(BinaryTraceHeader) == 24, "unexpected binary trace header size");
+static_assert(sizeof(BinaryTraceRecord) == 12, "unexpected binary trace record size");
+
+#endif // TRACE_FORMAT_H
@@ -0,0 +1,103 @@
+#include "trace_gen.h"
+#include "processor.h"
+
+// Code footprint of the generated instruction addresses (a loop of this many instructions)
+#define TRACE_GEN_LOOP_SIZE 4096
+#define TRACE_GEN_BASE_PC 0x400000
+
+// Registers the latency-mix pattern draws its sources from (recently written ones)
+#define TRACE_GEN_MIX_REGISTERS 16
+
+const TracePattern ALL_TRACE_PATTERNS[4] = {
+    TracePattern::Chain, TracePattern::Parallel, TracePattern::LatencyMix, TracePattern::RegisterPressure
+};
+
+// Name of a pattern
+const char* tracePatternName(TracePattern pattern) {
+    switch (pattern) {
+        case TracePattern::Chain:            return "chain";
+        case TracePattern::Parallel:         return "parallel";
+        case TracePattern::LatencyMix:       return "latency-mix";
+        case TracePattern::RegisterPressure: return "register-pressure";
+    }
+    return "unknown";
+}
+
+// Parse a pattern name
+bool parseTracePattern(const std::string& name, TracePattern& pattern) {
+    for (TracePattern candidate : ALL_TRACE_PATTERNS) {
+        if (name == tracePatternName(candidate)) {
+            pattern = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+TraceGenerator::TraceGenerator(TracePattern pattern, uint64_t seed) :
+    m_pattern(pattern),
+    m_state(seed),
+    m_index(0)
+{}
+
+// splitmix64: small, fast and identical everywhere, unlike the standard distributions
+uint64_t TraceGenerator::random() {
+    uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Produce the next record of the pattern
+TraceRecord TraceGenerator::next() {
+    TraceRecord record;
+    uint64_t index = m_index++;
+    record.pc = TRACE_GEN_BASE_PC + 4 * (index % TRACE_GEN_LOOP_SIZE);
+
+    switch (m_pattern) {
+        case TracePattern::Chain:
+            // Each instruction consumes the previous result
+            record.opType = static_cast<int>(random() % 3);
+            record.destReg = 1;
+            record.src1Reg = 1;
+            record.src2Reg = -1;
+            break;
+
+        case TracePattern::Parallel:
+            // Single-cycle operations with no sources
+            record.opType = 0;
+            record.destReg = static_cast<int>(index % ARF_SIZE);
+            record.src1Reg = -1;
+            record.src2Reg = -1;
+            break;
+
+        case TracePattern::LatencyMix:
+            // Short dependencies among a small set of registers across all latencies
+            record.opType = static_cast<int>(random() % 3);
+            record.destReg = static_cast<int>(random() % TRACE_GEN_MIX_REGISTERS);
+            record.src1Reg = static_cast<int>(random() % TRACE_GEN_MIX_REGISTERS);
+            record.src2Reg = random() % 2 ? static_cast<int>(random() % TRACE_GEN_MIX_REGISTERS) : -1;
+            break;
+
+        case TracePattern::RegisterPressure:
+            // Destinations sweep every register; sources are the values written one and two
+            // thirds of a sweep earlier, so the whole register file stays live
+            record.opType = static_cast<int>(random() % 3);
+            record.destReg = static_cast<int>(index % ARF_SIZE);
+            record.src1Reg = static_cast<int>((index + ARF_SIZE - ARF_SIZE / 3) % ARF_SIZE);
+            record.src2Reg = static_cast<int>((index + ARF_SIZE - 2 * ARF_SIZE / 3) % ARF_SIZE);
+            break;
+    }
+    return record;
+}
+
+// Generate length records of a pattern
+std::vector<TraceRecord> generateTrace(TracePattern pattern, uint64_t length, uint64_t seed) {
+    TraceGenerator generator(pattern, seed);
+    std::vector<TraceRecord> records;
+    records.reserve(length);
+    for (uint64_t i = 0; i < length; i++) {
+        records.push_back(generator.next());
+    }
+    return records;
+}
@@ -0,0 +1,68 @@
+#ifndef TRACE_GEN_H
+#define TRACE_GEN_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "instruction_source.h"
+#include "trace_format.h"
+
+// Synthetic Trace Patterns
+enum class TracePattern {
+    Chain,            // One serial dependency chain through a single register, mixed latencies
+    Parallel,         // No true dependencies: sources are unused, destinations rotate
+    LatencyMix,       // Uniform mix of op types 0/1/2 reading recently written registers
+    RegisterPressure  // Every architectural register live, sources written long before
+};
+
+// Every pattern, in the order benchmarks report them
+extern const TracePattern ALL_TRACE_PATTERNS[4];
+
+// Name of a pattern as accepted by parseTracePattern
+const char* tracePatternName(TracePattern pattern);
+
+// Parse a pattern name (chain, parallel, latency-mix, register-pressure); returns false if unknown
+bool parseTracePattern(const std::string& name, TracePattern& pattern);
+
+// TraceGenerator: Produces an endless synthetic instruction stream of one pattern
+class TraceGenerator {
+private:
+    TracePattern m_pattern;
+    uint64_t m_state;  // splitmix64 state
+    uint64_t m_index;  // Number of records generated so far
+
+    uint64_t random();
+
+public:
+    TraceGenerator(TracePattern pattern, uint64_t seed);
+
+    TraceRecord next();
+};
+
+// GeneratedInstructionSource: Streams length records of a pattern without storing them
+class GeneratedInstructionSource : public InstructionSource {
+private:
+    TraceGenerator m_generator;
+    uint64_t m_remaining;  // Records still to be generated
+
+public:
+    GeneratedInstructionSource(TracePattern pattern, uint64_t length, uint64_t seed = 1) :
+        m_generator(pattern, seed),
+        m_remaining(length)
+    {}
+
+    bool next(TraceRecord& record) override {
+        if (m_remaining == 0) {
+            return false;
+        }
+        m_remaining--;
+        record = m_generator.next();
+        return true;
+    }
+};
+
+// Generate length records of a pattern. The stream depends only on the arguments, so the same
+// seed reproduces the same trace on every platform.
+std::vector<TraceRecord> generateTrace(TracePattern pattern, uint64_t length, uint64_t seed = 1);
+
+#endif // TRACE_GEN_H
@@ -0,0 +1,110 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// WorkStealingPool: Runs a fixed batch of independent jobs on a set of worker threads.
+// Jobs are dealt round-robin into per-worker queues; a worker takes jobs from the front of its
+// own queue and, once that is empty, steals from the back of the other workers' queues, so
+// long-running jobs never leave the remaining cores idle.
+class WorkStealingPool {
+private:
+    // Per-worker job queue
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    size_t m_threadCount;  // Number of worker threads
+
+    // Take the next job for a worker: its own oldest job, else another worker's newest
+    static bool takeJob(std::vector<std::unique_ptr<WorkerQueue>>& queues, size_t worker, size_t& job) {
+        {
+            WorkerQueue& own = *queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty()) {
+                job = own.jobs.front();
+                own.jobs.pop_front();
+                return true;
+            }
+        }
+
+        for (size_t i = 1; i < queues.size(); i++) {
+            WorkerQueue& victim = *queues[(worker + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job = victim.jobs.back();
+                victim.jobs.pop_back();
+                return true;
+            }
+        }
+
+        // No job is ever added after start-up, so every queue stays empty from here on
+        return false;
+    }
+
+public:
+    explicit WorkStealingPool(size_t threadCount) :
+        m_threadCount(threadCount == 0 ? 1 : threadCount)
+    {}
+
+    size_t threadCount() const { return m_threadCount; }
+
+    // Run job(i) for every i in [0, jobCount) and wait for all of them.
+    // The first exception thrown by a job is rethrown once every worker has stopped.
+    void run(size_t jobCount, const std::function<void(size_t)>& job) {
+        size_t workers = std::min(m_threadCount, jobCount);
+        if (workers == 0) {
+            return;
+        }
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        for (size_t w = 0; w < workers; w++) {
+            queues.emplace_back(new WorkerQueue());
+        }
+        for (size_t i = 0; i < jobCount; i++) {
+            queues[i % workers]->jobs.push_back(i);
+        }
+
+        std::mutex errorMutex;
+        std::exception_ptr error;
+
+        auto workerLoop = [&](size_t worker) {
+            size_t index;
+            while (takeJob(queues, worker, index)) {
+                try {
+                    job(index);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        // The calling thread works as worker 0
+        std::vector<std::thread> threads;
+        for (size_t w = 1; w < workers; w++) {
+            threads.emplace_back(workerLoop, w);
+        }
+        workerLoop(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+#endif // WORK_STEALING_POOL_H